@@ -7,6 +7,11 @@
 #include <numeric>
 #include <cstdlib>   
 #include <ctime> 
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
 
 using namespace std;
 
@@ -92,22 +97,9 @@ int calculate_total_unoccupied_time(const vector<vector<int>>& durations, const
 }
 
 //----------------------optimal solution----------------------------------
-int calculate_total_unoccupied_time_brute(const vector<vector<int>>& durations, const vector<int>& inspection_times) {
-    int L = durations.size();
-    int total_unoccupied = 0;
-    for (int i = 0; i < inspection_times.size(); ++i) {
-        int inspect_time = inspection_times[i];
-        for (int l = 0; l < L; ++l) {
-            if ((int)durations[l].size() > i) {
-                int finish_time = compute_finish_time(durations[l], i + 1);
-                total_unoccupied += max(0, inspect_time - finish_time);
-            }
-        }
-    }
-    return total_unoccupied;
-}
-
-vector<int> generate_next_combination(vector<int> current, int T) {
+// Advances current to the next C-combination of 1..T in lexicographic order,
+// in place. Returns false after the last one.
+bool generate_next_combination(vector<int>& current, int T) {
     int n = current.size();
     for (int i = n - 1; i >= 0; --i) {
         if (current[i] < T - (n - 1 - i)) {
@@ -115,50 +107,276 @@ vector<int> generate_next_combination(vector<int> current, int T) {
             for (int j = i + 1; j < n; ++j) {
                 current[j] = current[j - 1] + 1;
             }
-            return current;
+            return true;
         }
     }
-    return {};
+    return false;
 }
 
-vector<int> optimal_brute_force(const vector<vector<int>>& durations, int L, int C, int T) {
-    vector<int> best_schedule;
-    int min_unoccupied = numeric_limits<int>::max();
+// Number of k-combinations of n items, saturating at LLONG_MAX.
+long long binomial(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    k = min(k, n - k);
+    long long res = 1;
+    for (int i = 1; i <= k; ++i) {
+        long long factor = n - i + 1;
+        if (res > numeric_limits<long long>::max() / factor) return numeric_limits<long long>::max();
+        res = res * factor / i;
+    }
+    return res;
+}
+
+// The C-combination of 1..T with the given lexicographic rank.
+vector<int> unrank_combination(long long rank, int C, int T) {
     vector<int> current(C);
-    for (int i = 0; i < C; ++i) current[i] = i + 1;  // Start from 1 instead of 0 to avoid meaningless early inspections
+    int v = 1;
+    for (int j = 0; j < C; ++j, ++v) {
+        // combinations with v at position j: choose the rest from v+1..T
+        for (long long count; (count = binomial(T - v, C - j - 1)) <= rank; ++v)
+            rank -= count;
+        current[j] = v;
+    }
+    return current;
+}
 
-    while (!current.empty() && current.back() < T) {
-        bool valid = true;
-        for (int i = 0; i < C; ++i) {
-            int must_time = 0;
-            for (auto &lab : durations) {
-                if ((int)lab.size() > i) {
-                    must_time = max(
-                      must_time,
-                      compute_finish_time(lab, i+1)
-                    );
-                }
+// Per-position requirement, lab count and finish-time sum, computed once.
+// A schedule is valid when every time reaches its requirement; then no idle
+// term is clamped and position i costs count[i] * t - sum[i].
+struct GridProblem {
+    int C = 0, T = 0;
+    vector<int> must_time;
+    vector<int> count;
+    vector<long long> sum;
+};
+
+GridProblem build_grid_problem(const vector<vector<int>>& durations, int C, int T) {
+    GridProblem p;
+    p.C = C;
+    p.T = T;
+    p.must_time.assign(C, 0);
+    p.count.assign(C, 0);
+    p.sum.assign(C, 0);
+    for (int i = 0; i < C; ++i) {
+        for (auto& lab : durations) {
+            if ((int)lab.size() > i) {
+                int finish_time = compute_finish_time(lab, i + 1);
+                p.must_time[i] = max(p.must_time[i], finish_time);
+                ++p.count[i];
+                p.sum[i] += finish_time;
             }
-            if (current[i] < must_time) {
+        }
+    }
+    return p;
+}
+
+// Best schedule of a rank range. Ties keep the lowest rank, as the serial
+// walk does, so merged shards reproduce the unsharded answer.
+struct GridIncumbent {
+    long long idle = -1;        // -1 until a valid schedule is seen
+    long long rank = -1;
+    vector<int> times;
+};
+
+// Walks ranks [first, last) and returns the rank it stopped at: last, or an
+// earlier rank when should_stop() asks for a checkpoint. should_stop is polled
+// once every CHECK_EVERY combinations.
+const long long CHECK_EVERY = 1 << 22;
+
+template <class StopFn>
+long long search_rank_range(const GridProblem& p, long long first, long long last, GridIncumbent& best,
+                            StopFn&& should_stop) {
+    if (first >= last) return last;
+    vector<int> current = unrank_combination(first, p.C, p.T);
+    for (long long rank = first; rank < last; ++rank) {
+        if ((rank - first) % CHECK_EVERY == CHECK_EVERY - 1 && should_stop()) return rank;
+
+        bool valid = true;
+        long long unoccupied = 0;
+        for (int i = 0; i < p.C; ++i) {
+            if (current[i] < p.must_time[i]) {
                 valid = false;
                 break;
             }
+            unoccupied += p.count[i] * (long long)current[i] - p.sum[i];
         }
-        if (valid){
-        int unoccupied = calculate_total_unoccupied_time_brute(durations, current);
-        if (unoccupied < min_unoccupied) {
-            min_unoccupied = unoccupied;
-            best_schedule = current;
+        if (valid && (best.idle < 0 || unoccupied < best.idle)) {
+            best.idle = unoccupied;
+            best.rank = rank;
+            best.times = current;
         }
+        generate_next_combination(current, p.T);
+    }
+    return last;
+}
+
+// Every C-combination of the times 1..T, including those that end at T.
+vector<int> optimal_brute_force(const vector<vector<int>>& durations, int L, int C, int T) {
+    (void)L;
+    GridProblem p = build_grid_problem(durations, C, T);
+    GridIncumbent best;
+    search_rank_range(p, 0, binomial(T, C), best, [] { return false; });
+
+    cout << "\nOptimal system (inspection times): ";
+    for (int t : best.times) cout << t << " ";
+    cout << "\nTotal optimal unoccupied time: ";
+    if (best.idle < 0) cout << "none";
+    else cout << best.idle;
+    cout << "\n";
+
+    return best.times;
+}
+
+//--------------------------sharded search-------------------------
+// One shard of the rank space [0, C(T, C)) for independent processes:
+// shard i of n owns [total * i / n, total * (i + 1) / n). Its state file is
+// rewritten atomically (temporary file, then rename) every checkpoint
+// interval and once more when the shard is done; a restarted shard resumes
+// from it. The same files are what --merge combines.
+struct ShardState {
+    unsigned long long seed = 0;
+    int L = 0, C = 0, T = 0;
+    int shard = 0, shards = 1;
+    long long next_rank = 0, end_rank = 0;
+    bool done = false;
+    GridIncumbent best;
+};
+
+bool write_shard_state(const string& path, const ShardState& s) {
+    string temporary = path + ".tmp";
+    {
+        ofstream out(temporary);
+        if (!out) return false;
+        out << "seed " << s.seed << "\nlabs " << s.L << "\ninspections " << s.C << "\nhorizon " << s.T
+            << "\nshard " << s.shard << " " << s.shards << "\nnext_rank " << s.next_rank
+            << "\nend_rank " << s.end_rank << "\nbest_idle " << s.best.idle << "\nbest_rank " << s.best.rank
+            << "\nbest_times";
+        for (int t : s.best.times) out << " " << t;
+        out << "\ndone " << s.done << "\n";
+        if (!out) return false;
+    }
+    return rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+bool read_shard_state(const string& path, ShardState& s) {
+    ifstream in(path);
+    if (!in) return false;
+    string key;
+    while (in >> key) {
+        if (key == "seed") in >> s.seed;
+        else if (key == "labs") in >> s.L;
+        else if (key == "inspections") in >> s.C;
+        else if (key == "horizon") in >> s.T;
+        else if (key == "shard") in >> s.shard >> s.shards;
+        else if (key == "next_rank") in >> s.next_rank;
+        else if (key == "end_rank") in >> s.end_rank;
+        else if (key == "best_idle") in >> s.best.idle;
+        else if (key == "best_rank") in >> s.best.rank;
+        else if (key == "best_times") {
+            s.best.times.clear();
+            string rest;
+            getline(in, rest);
+            stringstream ts(rest);
+            for (int t; ts >> t;) s.best.times.push_back(t);
+        }
+        else if (key == "done") in >> s.done;
+        else return false;
+    }
+    return true;
+}
+
+int run_shard(const vector<vector<int>>& durations, ShardState s, const string& path, int checkpoint_seconds) {
+    long long total = binomial(s.T, s.C);
+    if (total == numeric_limits<long long>::max()) {
+        cerr << "C(" << s.T << ", " << s.C << ") does not fit in 64 bits\n";
+        return 1;
+    }
+    s.next_rank = total / s.shards * s.shard + min<long long>(s.shard, total % s.shards);
+    s.end_rank = total / s.shards * (s.shard + 1) + min<long long>(s.shard + 1, total % s.shards);
+
+    ShardState saved;
+    if (read_shard_state(path, saved)) {
+        if (saved.seed != s.seed || saved.L != s.L || saved.C != s.C || saved.T != s.T ||
+            saved.shard != s.shard || saved.shards != s.shards || saved.end_rank != s.end_rank) {
+            cerr << path << " belongs to a different run; remove it to start over\n";
+            return 1;
+        }
+        s = saved;
+        cout << "Resuming shard " << s.shard << "/" << s.shards << " at rank " << s.next_rank << "\n";
+    }
+
+    GridProblem p = build_grid_problem(durations, s.C, s.T);
+    auto last_checkpoint = chrono::steady_clock::now();
+    while (!s.done) {
+        s.next_rank = search_rank_range(p, s.next_rank, s.end_rank, s.best, [&] {
+            return chrono::steady_clock::now() - last_checkpoint >= chrono::seconds(checkpoint_seconds);
+        });
+        s.done = (s.next_rank == s.end_rank);
+        if (!write_shard_state(path, s)) {
+            cerr << "cannot write " << path << "\n";
+            return 1;
+        }
+        last_checkpoint = chrono::steady_clock::now();
+    }
+
+    cout << "Shard " << s.shard << "/" << s.shards << ": ranks [" << total / s.shards * s.shard +
+            min<long long>(s.shard, total % s.shards) << ", " << s.end_rank << ") of " << total << "\n";
+    cout << "Shard best idle: ";
+    if (s.best.idle < 0) cout << "none";
+    else cout << s.best.idle;
+    cout << "\n";
+    return 0;
+}
+
+// Combines finished shard files into the global optimum. Every shard of one
+// run has to be present and done.
+int merge_shards(const vector<string>& paths) {
+    vector<ShardState> states;
+    for (const string& path : paths) {
+        ShardState s;
+        if (!read_shard_state(path, s)) {
+            cerr << "cannot read " << path << "\n";
+            return 1;
         }
-        current = generate_next_combination(current, T);
+        if (!s.done) {
+            cerr << path << ": shard " << s.shard << "/" << s.shards << " has not finished\n";
+            return 1;
+        }
+        states.push_back(s);
+    }
+    if (states.empty()) {
+        cerr << "nothing to merge\n";
+        return 1;
     }
 
-   cout << "\nOptimal system (inspection times): ";
-    for (int t : best_schedule) cout << t << " ";
-    cout << "\nTotal optimal unoccupied time: " << min_unoccupied << "\n";
+    const ShardState& run = states[0];
+    vector<bool> seen(run.shards, false);
+    GridIncumbent best;
+    for (const ShardState& s : states) {
+        if (s.seed != run.seed || s.L != run.L || s.C != run.C || s.T != run.T || s.shards != run.shards ||
+            s.shard < 0 || s.shard >= run.shards || seen[s.shard]) {
+            cerr << "shard " << s.shard << "/" << s.shards << " does not belong to this run or is repeated\n";
+            return 1;
+        }
+        seen[s.shard] = true;
+        if (s.best.idle >= 0 && (best.idle < 0 || s.best.idle < best.idle ||
+                                 (s.best.idle == best.idle && s.best.rank < best.rank)))
+            best = s.best;
+    }
+    int missing = count(seen.begin(), seen.end(), false);
+    if (missing > 0) {
+        cerr << missing << " of " << run.shards << " shards are missing\n";
+        return 1;
+    }
 
-    return best_schedule;
+    cout << "Merged " << run.shards << " shards (seed " << run.seed << ", L=" << run.L << ", C=" << run.C
+         << ", T=" << run.T << ")";
+    cout << "\nOptimal system (inspection times): ";
+    for (int t : best.times) cout << t << " ";
+    cout << "\nTotal optimal unoccupied time: ";
+    if (best.idle < 0) cout << "none";
+    else cout << best.idle;
+    cout << "\n";
+    return 0;
 }
 
 //--------------------------generate instances-------------------------
@@ -173,12 +391,36 @@ vector<vector<int>> generate_random_instance(int L, int max_students, int max_du
     return durations;
 }
 
-int main() {
-   int L = 3, C = 2, D = 1;
+// Removes "name value" from the command line and returns value, or fallback
+// when the option is absent.
+string take_option(int& argc, char* argv[], const string& name, const string& fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            string value = argv[i + 1];
+            for (int j = i; j + 2 < argc; ++j) argv[j] = argv[j + 2];
+            argc -= 2;
+            return value;
+        }
+    }
+    return fallback;
+}
+
+// approx_rand [--seed S] [--labs L] [--inspections C] [--days D]
+//             [--shard i/n [--checkpoint PATH] [--checkpoint-every SECONDS]]
+// approx_rand --merge shard files...
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--merge")
+        return merge_shards(vector<string>(argv + 2, argv + argc));
+
+    int L = atoi(take_option(argc, argv, "--labs", "3").c_str());
+    int C = atoi(take_option(argc, argv, "--inspections", "2").c_str());
+    int D = atoi(take_option(argc, argv, "--days", "1").c_str());
     int T = D * 24;
 
-    // seed RNG
-    srand(static_cast<unsigned>(time(nullptr)));
+    // seed RNG; shards of one run must share the seed to see the same instance
+    unsigned long long seed = strtoull(take_option(argc, argv, "--seed", to_string(time(nullptr))).c_str(), nullptr, 10);
+    cerr << "Seed: " << seed << "\n";
+    srand(static_cast<unsigned>(seed));
 
     // randomize bounds
     int max_students = rand() % 10 + 1;  // 1..10
@@ -195,6 +437,24 @@ int main() {
         cout << "\n";
     }
 
+    string shard = take_option(argc, argv, "--shard", "");
+    if (!shard.empty()) {
+        ShardState s;
+        s.seed = seed;
+        s.L = L;
+        s.C = C;
+        s.T = T;
+        if (sscanf(shard.c_str(), "%d/%d", &s.shard, &s.shards) != 2 || s.shards < 1 || s.shard < 0 ||
+            s.shard >= s.shards) {
+            cerr << "--shard expects i/n with 0 <= i < n\n";
+            return 1;
+        }
+        string path = take_option(argc, argv, "--checkpoint",
+                                  "shard_" + to_string(s.shard) + "_of_" + to_string(s.shards) + ".ckpt");
+        int every = atoi(take_option(argc, argv, "--checkpoint-every", "30").c_str());
+        return run_shard(durations, s, path, max(1, every));
+    }
+
     // heuristic solution
     auto times = schedule_inspections(durations, L, C, T);
     int idle_approx = calculate_total_unoccupied_time(durations, times);
@@ -207,4 +467,3 @@ int main() {
 
     return 0;
 }
-
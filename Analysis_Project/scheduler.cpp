@@ -1,109 +1,585 @@
 #include <iostream>
 #include <vector>
+#include <array>
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <set>
 #include <numeric>
 #include <cstdlib>
+#include <cstdint>
 #include <ctime>
 #include <chrono>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <deque>
+#include <string>
+#include <map>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define SCHEDULER_HAS_MMAP 1
+#endif
+#ifndef SCHEDULER_INSTRUMENT
+#define SCHEDULER_INSTRUMENT 0
+#endif
+#if SCHEDULER_INSTRUMENT && defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define SCHEDULER_HAS_PERF 1
+#endif
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SCHEDULER_X86_KERNELS 1
+#endif
 
 
 using namespace std;
 using namespace std::chrono;
 
+// Preprocessed instance, built once per instance and shared by every solver.
+// Finish times (prefix sums of the sorted durations) are stored lab by lab in a
+// flat CSR layout: lab l's finish time after k students is
+// finish[offsets[l] + k - 1]. Each lab is truncated to the horizon T: we keep
+// every finish time <= T plus the first one past it, which is all that
+// feasibility and idle time for inspections within [0, T] depend on.
+struct Instance {
+    int L = 0;              // Number of labs
+    int T = 0;              // Time horizon
+    vector<int> offsets;    // L + 1 offsets into finish
+    vector<int> finish;     // Truncated finish times, lab after lab
+    vector<int> students;   // Untruncated number of students per lab
+
+    // The same finish times transposed by inspection index for the SIMD idle
+    // kernels: row i holds finish_l(i+1) for every lab at by_index[i * stride + l].
+    // Labs without an (i+1)-th student and the padding up to stride hold
+    // IDLE_SENTINEL, whose clamped contribution is always zero. Only the rows
+    // a schedule can reach are built: a model built for at most C inspections
+    // must not be asked for the idle of a longer schedule.
+    int rows = 0;           // Longest truncated lab, capped at the row limit
+    int stride = 0;         // L rounded up to a multiple of 16
+    vector<int> by_index;
+};
+
+const int IDLE_SENTINEL = numeric_limits<int>::max();
+
+// Raw durations of a whole instance in CSR form: lab l's sorted durations are
+// durations[offsets[l]] .. durations[offsets[l + 1] - 1].
+struct DurationsCsr {
+    vector<uint64_t> offsets;
+    vector<int> durations;
+};
+
+// Counter-based generator built on the SplitMix64 mixer. Draw k of stream
+// (seed, instance_id, lab) is a pure function of those four numbers, so any
+// thread can regenerate any lab of any instance in O(1) without shared state.
+struct CounterRng {
+    uint64_t key;
+    uint64_t counter = 0;
+
+    static uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    CounterRng(uint64_t seed, uint64_t instance_id, uint64_t lab)
+        : key(mix(mix(mix(seed) ^ instance_id) ^ lab)) {}
+
+    uint64_t next() { return mix(key + counter++); }
+
+    // Uniform integer in [lo, hi] (multiply-shift, no modulo)
+    int uniform(int lo, int hi) {
+        uint64_t span = (uint64_t)(hi - lo) + 1;
+        return lo + (int)(((next() >> 32) * span) >> 32);
+    }
+};
+
+// Stream reserved for an instance's own parameters (max_students, max_duration)
+const uint64_t PARAMS_STREAM = numeric_limits<uint64_t>::max();
+
+// Kernel used by calculate_total_unoccupied_time. All kernels produce
+// bit-identical results; the fastest one the CPU supports is picked at runtime.
+enum class IdleKernel { Scalar, AVX2, AVX512 };
+
+// Order in which optimal_brute_force walks the C-combinations of the events.
+// RevolvingDoor is a Gray code: each step swaps one event for another and
+// touches at most two sorted positions, so the idle is updated in O(1).
+enum class Enumeration { Lexicographic, RevolvingDoor };
+
+// Largest C with a compile-time specialized lexicographic brute force.
+const int MAX_SPECIALIZED_C = 8;
+
 // Forward declarations
-int compute_finish_time(const vector<int>& durations, int k);
-vector<int> schedule_inspections(const vector<vector<int>>& durations, int L, int C, int T);
-int calculate_total_unoccupied_time(const vector<vector<int>>& durations, const vector<int>& inspection_times);
+Instance build_instance(const vector<vector<int>>& durations, int T, int max_rows = numeric_limits<int>::max());
+int finish_time(const Instance& inst, int l, int k);
+vector<int> collect_events(const Instance& inst);
+vector<int> schedule_inspections(const Instance& inst, int C);
+int calculate_total_unoccupied_time(const Instance& inst, const vector<int>& inspection_times);
+int calculate_total_unoccupied_time(const Instance& inst, const vector<int>& inspection_times, IdleKernel kernel);
+IdleKernel best_idle_kernel();
 vector<int> generate_next_combination(vector<int> current, int T);
-vector<int> optimal_brute_force(const vector<vector<int>>& durations, int L, int C, int T);
-vector<vector<int>> generate_random_instance(int L, int max_students, int max_duration);
+vector<int> optimal_brute_force(const Instance& inst, int C, Enumeration order = Enumeration::Lexicographic);
+vector<int> optimal_brute_force_revolving_door(const Instance& inst, int C);
+vector<int> optimal_brute_force_generic(const Instance& inst, int C);
+vector<int> optimal_brute_force_specialized(const Instance& inst, int C);
+vector<vector<int>> generate_random_instance(int L, int max_students, int max_duration, uint64_t seed, int instance_id);
+vector<vector<int>> generate_instance(int L, uint64_t seed, int instance_id);
+DurationsCsr generate_bulk_instance(int L, int max_students, int max_duration, uint64_t seed, int instance_id, int num_threads);
+Instance build_instance(int L, const uint64_t* offsets, const int* durations, int T, const int* prefix = nullptr,
+                        int max_rows = numeric_limits<int>::max());
+bool build_instance_into(Instance& inst, int L, const uint64_t* offsets, const int* durations, int T,
+                         const int* prefix = nullptr, int max_rows = numeric_limits<int>::max());
+vector<int> optimal_dp(const Instance& inst, int C);
+long long binomial(int n, int k);
+vector<int> optimal_brute_force_parallel(const Instance& inst, int C, int num_threads);
+vector<int> optimal_branch_and_bound(const Instance& inst, int C, long long* nodes_visited = nullptr);
+
+//--------------------------instrumentation-------------------------
+// Solver counters and per-phase timings, compiled in with
+// -DSCHEDULER_INSTRUMENT=1. Otherwise INSTRUMENT_COUNT and INSTRUMENT_PHASE
+// expand to nothing and the solvers are unchanged. Counters are per thread, so
+// the batch workers never share them; solve_instance resets them per instance
+// and renders them as one JSON object. On Linux each phase also reads the
+// hardware counters through perf_event_open when the kernel allows it.
+#if SCHEDULER_INSTRUMENT
+
+struct PhaseMetrics {
+    const char* name = "";
+    long long ns = 0;
+    bool hardware = false;          // Whether the four counters below are valid
+    long long cycles = 0;
+    long long instructions = 0;
+    long long cache_misses = 0;
+    long long branch_misses = 0;
+};
+
+struct SolverCounters {
+    // Brute forces: every candidate schedule is counted once, as feasible or
+    // infeasible, including those of a subtree cut at once. Branch and bound:
+    // combinations counts search nodes, feasible the complete schedules
+    // reached and infeasible the branches cut for having no feasible
+    // completion (bound cuts are in neither).
+    long long combinations = 0;
+    long long feasible = 0;
+    long long infeasible = 0;
+    long long improvements = 0;     // Times the incumbent got better
+    long long events = 0;           // Distinct events within the horizon, once per instance
+    vector<PhaseMetrics> phases;
+
+    void reset() { *this = SolverCounters(); }
+};
+
+thread_local SolverCounters solver_counters;
+
+// One perf_event group per thread: cycles leads, the other three follow, and
+// a single read returns all four. Unavailable (no Linux, no permission, or a
+// virtualized PMU) leaves ok false and phases report times only.
+class HardwareCounters {
+public:
+    static const int COUNT = 4;
+
+    HardwareCounters() {
+#ifdef SCHEDULER_HAS_PERF
+        const uint64_t configs[COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                          PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+        for (int k = 0; k < COUNT; ++k) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[k];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.disabled = (k == 0);
+            fds_[k] = syscall(__NR_perf_event_open, &attr, 0, -1, k == 0 ? -1 : fds_[0], 0);
+            if (fds_[k] < 0) return;
+        }
+        ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        ok_ = true;
+#endif
+    }
+
+    ~HardwareCounters() {
+#ifdef SCHEDULER_HAS_PERF
+        for (int fd : fds_)
+            if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    bool read(long long values[COUNT]) const {
+#ifdef SCHEDULER_HAS_PERF
+        uint64_t buffer[1 + COUNT];
+        if (!ok_ || ::read(fds_[0], buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) return false;
+        for (int k = 0; k < COUNT; ++k) values[k] = buffer[1 + k];
+        return true;
+#else
+        (void)values;
+        return false;
+#endif
+    }
+
+    static const HardwareCounters& for_thread() {
+        thread_local HardwareCounters counters;
+        return counters;
+    }
+
+private:
+    int fds_[COUNT] = { -1, -1, -1, -1 };
+    bool ok_ = false;
+};
+
+// Times the enclosing scope and appends it to the thread's phase list.
+class PhaseProbe {
+public:
+    explicit PhaseProbe(const char* name) : name_(name) {
+        hardware_ = HardwareCounters::for_thread().read(start_counts_);
+        start_ = steady_clock::now();
+    }
+
+    ~PhaseProbe() {
+        PhaseMetrics m;
+        m.ns = duration_cast<nanoseconds>(steady_clock::now() - start_).count();
+        long long end_counts[HardwareCounters::COUNT];
+        m.name = name_;
+        m.hardware = hardware_ && HardwareCounters::for_thread().read(end_counts);
+        if (m.hardware) {
+            m.cycles = end_counts[0] - start_counts_[0];
+            m.instructions = end_counts[1] - start_counts_[1];
+            m.cache_misses = end_counts[2] - start_counts_[2];
+            m.branch_misses = end_counts[3] - start_counts_[3];
+        }
+        solver_counters.phases.push_back(m);
+    }
+
+private:
+    const char* name_;
+    bool hardware_ = false;
+    long long start_counts_[HardwareCounters::COUNT];
+    steady_clock::time_point start_;
+};
+
+// The thread's counters as one JSON object (no trailing newline).
+string solver_counters_json(int instance_id, int C) {
+    const SolverCounters& s = solver_counters;
+    ostringstream out;
+    out << "{\"instance\":" << instance_id << ",\"C\":" << C << ",\"events\":" << s.events
+        << ",\"combinations\":" << s.combinations << ",\"feasible\":" << s.feasible
+        << ",\"infeasible\":" << s.infeasible << ",\"improvements\":" << s.improvements << ",\"phases\":[";
+    for (size_t k = 0; k < s.phases.size(); ++k) {
+        const PhaseMetrics& p = s.phases[k];
+        out << (k ? "," : "") << "{\"name\":\"" << p.name << "\",\"ns\":" << p.ns;
+        if (p.hardware)
+            out << ",\"cycles\":" << p.cycles << ",\"instructions\":" << p.instructions
+                << ",\"cache_misses\":" << p.cache_misses << ",\"branch_misses\":" << p.branch_misses;
+        out << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_COUNT(field, n) (solver_counters.field += (n))
+#define INSTRUMENT_PHASE(name) PhaseProbe INSTRUMENT_CONCAT(phase_probe_, __LINE__)(name)
+
+#else
+
+#define INSTRUMENT_COUNT(field, n) ((void)0)
+#define INSTRUMENT_PHASE(name) ((void)0)
+
+#endif
+
+Instance build_instance(const vector<vector<int>>& durations, int T, int max_rows) {
+    DurationsCsr csr;
+    csr.offsets.push_back(0);
+    for (const auto& lab : durations) {
+        csr.durations.insert(csr.durations.end(), lab.begin(), lab.end());
+        csr.offsets.push_back(csr.durations.size());
+    }
+    return build_instance(durations.size(), csr.offsets.data(), csr.durations.data(), T, nullptr, max_rows);
+}
 
-int compute_finish_time(const vector<int>& durations, int k) {
-    return accumulate(durations.begin(), durations.begin() + min(k, (int)durations.size()), 0);
+// Builds the model straight from CSR durations (L + 1 offsets), e.g. from the
+// bulk generator or a mapped instance file, without one vector per lab. When
+// the per-lab prefix sums are already available they are used as-is and
+// durations may be null. A caller that solves for a known number of
+// inspections C passes it as max_rows, so one long lab does not size the
+// transposed table at L times its length.
+Instance build_instance(int L, const uint64_t* offsets, const int* durations, int T, const int* prefix,
+                        int max_rows) {
+    Instance inst;
+    build_instance_into(inst, L, offsets, durations, T, prefix, max_rows);
+    return inst;
+}
+
+// build_instance into an existing model, reusing its buffers, so a caller that
+// builds many instances (e.g. a service worker) stops allocating once warm.
+// Returns false, leaving the model unusable, when a duration is negative, a
+// prefix decreases or a finish time overflows an int.
+bool build_instance_into(Instance& inst, int L, const uint64_t* offsets, const int* durations, int T, const int* prefix,
+                         int max_rows) {
+    inst.L = L;
+    inst.T = T;
+    inst.rows = 0;
+    inst.finish.clear();
+    inst.offsets.assign(inst.L + 1, 0);
+    inst.students.resize(inst.L);
+    for (int l = 0; l < inst.L; ++l) {
+        inst.students[l] = offsets[l + 1] - offsets[l];
+        long long running = 0;
+        for (uint64_t j = offsets[l]; j < offsets[l + 1]; ++j) {
+            long long next = prefix ? prefix[j] : running + durations[j];
+            if (next < running || next > numeric_limits<int>::max()) return false;
+            running = next;
+            inst.finish.push_back(running);
+            if (running > T) break; // first finish time past the horizon is the last one kept
+        }
+        inst.offsets[l + 1] = inst.finish.size();
+        inst.rows = max(inst.rows, inst.offsets[l + 1] - inst.offsets[l]);
+    }
+    inst.rows = min(inst.rows, max_rows);
+
+    inst.stride = (inst.L + 15) / 16 * 16;
+    inst.by_index.assign((size_t)inst.rows * inst.stride, IDLE_SENTINEL);
+    for (int l = 0; l < inst.L; ++l) {
+        int k = min(inst.rows, inst.students[l]);
+        for (int i = 0; i < k; ++i)
+            inst.by_index[(size_t)i * inst.stride + l] = finish_time(inst, l, i + 1);
+    }
+    return true;
+}
+
+// Finish time of lab l after its first k students (1 <= k <= students[l]).
+// Beyond the truncated prefix the exact value is past T and never matters,
+// so the first past-horizon finish time stands in for it.
+int finish_time(const Instance& inst, int l, int k) {
+    int stored = inst.offsets[l + 1] - inst.offsets[l];
+    return inst.finish[inst.offsets[l] + min(k, stored) - 1];
+}
+
+// Sorted, distinct finish times in [0, T]: the only useful inspection times.
+// When the horizon is short next to the number of finish times they are
+// marked in a table over [0, T], O(L·rows + T); otherwise sorted, so cost and
+// memory follow the finish times rather than T.
+vector<int> collect_events(const Instance& inst) {
+    vector<int> events;
+    size_t horizon = (size_t)inst.T + 1;
+    if (horizon <= 4 * inst.finish.size()) {
+        vector<char> seen(horizon, 0);
+        for (int ft : inst.finish) {
+            if (ft >= 0 && ft <= inst.T) seen[ft] = 1;
+        }
+        for (size_t t = 0; t < horizon; ++t) {
+            if (seen[t]) events.push_back(t);
+        }
+    } else {
+        for (int ft : inst.finish) {
+            if (ft >= 0 && ft <= inst.T) events.push_back(ft);
+        }
+        sort(events.begin(), events.end());
+        events.erase(unique(events.begin(), events.end()), events.end());
+    }
+    return events;
 }
 
-vector<int> schedule_inspections(const vector<vector<int>>& durations, int L, int C, int T) {
+vector<int> schedule_inspections(const Instance& inst, int C) {
+    const int L = inst.L;
+    const int T = inst.T;
     vector<int> inspection_times;
-    set<int> used_times;
 
     if (C == 1) {
         int max_finish = 0;
         for (int l = 0; l < L; ++l) {
-            if (!durations[l].empty()) {
-                max_finish = max(max_finish, durations[l][0]);
+            if (inst.students[l] > 0) {
+                max_finish = max(max_finish, finish_time(inst, l, 1));
             }
         }
         if (max_finish <= T) inspection_times.push_back(max_finish);
         return inspection_times;
     }
 
-    int max_students = 0;
-    for (const auto& lab : durations) {
-        max_students = max(max_students, (int)lab.size());
-    }
-
     double standard_interval = static_cast<double>(T) / (C + 1);
 
+    // With a horizon of at most a few times L, time-indexed tables are cheaper
+    // than hashing: the used times and the finish times present in the
+    // current row, with slot T + 1 absorbing everything past the horizon.
+    // Otherwise the used times (at most C) go in a hash set, so the cost
+    // stays independent of T.
+    const bool dense = (size_t)T + 2 <= (size_t)4 * max(L, 16);
+    vector<char> used_table, present;
+    unordered_set<int> used_set;
+    if (dense) {
+        used_table.assign(T + 2, 0);
+        present.assign(T + 2, 0);
+    } else {
+        used_set.reserve(C);
+    }
+
     for (int i = 1; i <= C; ++i) {
         double target_time = i * standard_interval;
-        vector<int> candidate_times;
+        const int* row = i <= inst.rows ? inst.by_index.data() + (size_t)(i - 1) * inst.stride : nullptr;
 
-        for (int l = 0; l < L; ++l) {
-            if ((int)durations[l].size() >= i) {
-                int finish_time = compute_finish_time(durations[l], i);
-                candidate_times.push_back(finish_time);
+        // Select the closest unused candidate to target_time, earlier on ties.
+        // Distances are truncated, so lo - d and hi + d are both at distance
+        // d. Finish times past the horizon (including the row padding) cannot
+        // be inspected within the day.
+        int lo = static_cast<int>(floor(target_time));
+        int hi = static_cast<int>(ceil(target_time));
+        int chosen_time = -1;
+        if (row && dense) {
+            // Mark the row in one branch-free pass, walk outward from the
+            // target, then clear the table or, if shorter, the marked slots
+            for (int l = 0; l < L; ++l) {
+                present[min(row[l], T + 1)] = 1;
             }
-        }
-
-        // Remove duplicates
-        candidate_times.erase(remove_if(candidate_times.begin(), candidate_times.end(),
-            [&](int t) { return used_times.count(t); }), candidate_times.end());
-
-        // Select the closest candidate to target_time
-        int chosen_time;
-        if (!candidate_times.empty()) {
-            chosen_time = candidate_times[0];
-            int min_diff = abs(candidate_times[0] - target_time);
-            for (int t : candidate_times) {
-                int diff = abs(t - target_time);
-                if (diff < min_diff || (diff == min_diff && t < chosen_time)) {
-                    min_diff = diff;
+            for (int d = 0; lo - d >= 0 || hi + d <= T; ++d) {
+                if (lo - d >= 0 && present[lo - d] && !used_table[lo - d]) {
+                    chosen_time = lo - d;
+                } else if (hi + d <= T && present[hi + d] && !used_table[hi + d]) {
+                    chosen_time = hi + d;
+                }
+                if (chosen_time >= 0) break;
+            }
+            if (T + 2 <= L) {
+                fill(present.begin(), present.end(), 0);
+            } else {
+                for (int l = 0; l < L; ++l) {
+                    present[min(row[l], T + 1)] = 0;
+                }
+            }
+        } else if (row) {
+            // One pass over the row; the used set is only consulted for a
+            // candidate that beats the best so far
+            int best_distance = numeric_limits<int>::max();
+            int rejected = -1;
+            for (int l = 0; l < L; ++l) {
+                int t = row[l];
+                if (t > T || t == rejected) continue;
+                int distance = t <= lo ? lo - t : t - hi;
+                if (distance < best_distance || (distance == best_distance && t < chosen_time)) {
+                    if (used_set.count(t)) {
+                        rejected = t;
+                        continue;
+                    }
+                    best_distance = distance;
                     chosen_time = t;
                 }
             }
         }
-        else {
+        if (chosen_time < 0) {
             chosen_time = static_cast<int>(round(target_time));
         }
 
         inspection_times.push_back(chosen_time);
-        used_times.insert(chosen_time);
+        if (dense) used_table[chosen_time] = 1;
+        else used_set.insert(chosen_time);
     }
     return inspection_times;
 }
 
 
-int calculate_total_unoccupied_time(const vector<vector<int>>& durations, const vector<int>& inspection_times) {
+// Clamped idle sum of one by_index row: sum over l of max(0, t - row[l]).
+// n is a multiple of 16.
+int idle_row_scalar(const int* row, int n, int t) {
+    int total = 0;
+    for (int l = 0; l < n; ++l)
+        total += max(0, t - row[l]);
+    return total;
+}
+
+#ifdef SCHEDULER_X86_KERNELS
+__attribute__((target("avx2")))
+int idle_row_avx2(const int* row, int n, int t) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vt = _mm256_set1_epi32(t);
+    __m256i acc0 = zero, acc1 = zero;
+    for (int l = 0; l < n; l += 16) {
+        __m256i f0 = _mm256_loadu_si256((const __m256i*)(row + l));
+        __m256i f1 = _mm256_loadu_si256((const __m256i*)(row + l + 8));
+        acc0 = _mm256_add_epi32(acc0, _mm256_max_epi32(zero, _mm256_sub_epi32(vt, f0)));
+        acc1 = _mm256_add_epi32(acc1, _mm256_max_epi32(zero, _mm256_sub_epi32(vt, f1)));
+    }
+    __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+__attribute__((target("avx512f")))
+int idle_row_avx512(const int* row, int n, int t) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i vt = _mm512_set1_epi32(t);
+    __m512i acc = zero;
+    for (int l = 0; l < n; l += 16) {
+        // max(0, t - f) as a zero-masked subtraction on the lanes with t > f
+        __m512i f = _mm512_loadu_si512((const void*)(row + l));
+        acc = _mm512_add_epi32(acc, _mm512_maskz_sub_epi32(_mm512_cmpgt_epi32_mask(vt, f), vt, f));
+    }
+    int lanes[16];
+    _mm512_storeu_si512((void*)lanes, acc);
+    int total = 0;
+    for (int x : lanes) total += x;
+    return total;
+}
+#endif
+
+IdleKernel best_idle_kernel() {
+#ifdef SCHEDULER_X86_KERNELS
+    static const IdleKernel best = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return IdleKernel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return IdleKernel::AVX2;
+        return IdleKernel::Scalar;
+    }();
+    return best;
+#else
+    return IdleKernel::Scalar;
+#endif
+}
+
+// Inspection times are expected within [0, T], where the truncated instance is
+// exact: rows past the longest truncated lab only hold finish times beyond T
+// and contribute nothing.
+int calculate_total_unoccupied_time(const Instance& inst, const vector<int>& inspection_times, IdleKernel kernel) {
+    int (*idle_row)(const int*, int, int) = idle_row_scalar;
+#ifdef SCHEDULER_X86_KERNELS
+    if (kernel == IdleKernel::AVX2) idle_row = idle_row_avx2;
+    if (kernel == IdleKernel::AVX512) idle_row = idle_row_avx512;
+#endif
+
     int total_unoccupied = 0;
-    int L = durations.size();
-    int C = inspection_times.size();
-    
+    int C = min((int)inspection_times.size(), inst.rows);
     for (int i = 0; i < C; ++i) {
-        int inspect_time = inspection_times[i];
-        for (int l = 0; l < L; ++l) {
-            if ((int)durations[l].size() > i) {
-                int finish_time = compute_finish_time(durations[l], i + 1);
-                total_unoccupied += max(0, inspect_time - finish_time);
-            }
-        }
+        total_unoccupied += idle_row(inst.by_index.data() + (size_t)i * inst.stride, inst.stride, inspection_times[i]);
     }
     return total_unoccupied;
 }
 
+int calculate_total_unoccupied_time(const Instance& inst, const vector<int>& inspection_times) {
+    return calculate_total_unoccupied_time(inst, inspection_times, best_idle_kernel());
+}
+
 vector<int> generate_next_combination(vector<int> current, int T) {
     int n = current.size();
     for (int i = n - 1; i >= 0; --i) {
@@ -118,24 +594,20 @@ vector<int> generate_next_combination(vector<int> current, int T) {
     return {};
 }
 
-vector<int> optimal_brute_force(
-    const vector<vector<int>>& durations,
-    int L,
-    int C,
-    int T
-) {
-    // 1. Collect valid finish times
-    set<int> unique_times;
-    for (int l = 0; l < L; ++l) {
-        for (int k = 1; k <= durations[l].size(); ++k) {
-            int finish_time = compute_finish_time(durations[l], k);
-            if (finish_time <= T) {
-                unique_times.insert(finish_time);
-            }
-        }
-    }
+vector<int> optimal_brute_force(const Instance& inst, int C, Enumeration order) {
+    if (order == Enumeration::RevolvingDoor)
+        return optimal_brute_force_revolving_door(inst, C);
+    if (C >= 1 && C <= MAX_SPECIALIZED_C)
+        return optimal_brute_force_specialized(inst, C);
+    return optimal_brute_force_generic(inst, C);
+}
 
-    vector<int> events(unique_times.begin(), unique_times.end());
+// Lexicographic brute force for any C; the fallback of optimal_brute_force.
+vector<int> optimal_brute_force_generic(const Instance& inst, int C) {
+    const int L = inst.L;
+
+    // 1. Collect valid finish times
+    vector<int> events = collect_events(inst);
     int N = events.size();
     if (N < C) return {}; // not enough options to pick from
 
@@ -156,8 +628,8 @@ vector<int> optimal_brute_force(
         bool feasible = true;
         for (int i = 0; i < C && feasible; ++i) {
             for (int l = 0; l < L; ++l) {
-                if ((int)durations[l].size() > i) {
-                    int required_time = compute_finish_time(durations[l], i + 1);
+                if (inst.students[l] > i) {
+                    int required_time = finish_time(inst, l, i + 1);
                     if (candidate[i] < required_time) {
                         feasible = false;
                         break;
@@ -166,12 +638,17 @@ vector<int> optimal_brute_force(
             }
         }
 
+        INSTRUMENT_COUNT(combinations, 1);
         if (feasible) {
-            int idle = calculate_total_unoccupied_time(durations, candidate);
+            INSTRUMENT_COUNT(feasible, 1);
+            int idle = calculate_total_unoccupied_time(inst, candidate);
             if (idle < best_idle) {
+                INSTRUMENT_COUNT(improvements, 1);
                 best_idle = idle;
                 best_schedule = candidate;
             }
+        } else {
+            INSTRUMENT_COUNT(infeasible, 1);
         }
 
         // Generate next combination
@@ -188,199 +665,3517 @@ vector<int> optimal_brute_force(
 
 
 
-vector<vector<int>> generate_random_instance(int L, int max_students, int max_duration) {
+// Number of students of one lab; the first draw of the lab's stream.
+int draw_lab_size(CounterRng& rng, int max_students) {
+    return rng.uniform(1, max_students);
+}
+
+// Fills one lab's sorted durations from the rest of its stream.
+void draw_lab_durations(CounterRng& rng, int max_duration, int* out, int count) {
+    for (int j = 0; j < count; ++j)
+        out[j] = rng.uniform(1, max_duration);
+    sort(out, out + count);
+}
+
+// Instance instance_id of seed: every lab has its own counter stream, so the
+// result does not depend on which thread generates it.
+vector<vector<int>> generate_random_instance(int L, int max_students, int max_duration, uint64_t seed, int instance_id) {
     vector<vector<int>> durations(L);
     for (int i = 0; i < L; ++i) {
-        int num_students = rand() % max_students + 1;
-        for (int j = 0; j < num_students; ++j) {
-            durations[i].push_back(rand() % max_duration + 1);
-        }
-        sort(durations[i].begin(), durations[i].end());
+        CounterRng rng(seed, instance_id, i);
+        durations[i].resize(draw_lab_size(rng, max_students));
+        draw_lab_durations(rng, max_duration, durations[i].data(), durations[i].size());
     }
     return durations;
 }
 
-vector<int> optimal_dp_2labs(const vector<vector<int>>& D2, int C, int T) {
-    // precompute finish[l][k]
-    vector<vector<int>> finish(2);
-    for (int l = 0; l < 2; ++l) {
-        int M = D2[l].size();
-        finish[l].assign(M+1, 0);
-        for (int k = 1; k <= M; ++k)
-            finish[l][k] = finish[l][k-1] + D2[l][k-1];
+// Instance with the driver's randomized bounds (1..10 students, durations
+// 1..24), themselves drawn from the instance's parameter stream.
+vector<vector<int>> generate_instance(int L, uint64_t seed, int instance_id) {
+    CounterRng params(seed, instance_id, PARAMS_STREAM);
+    int max_students = params.uniform(1, 10);
+    int max_duration = params.uniform(1, 24);
+    return generate_random_instance(L, max_students, max_duration, seed, instance_id);
+}
+
+// Same instance as generate_random_instance, built in parallel straight into
+// CSR form for millions of labs: one pass draws every lab's size, a prefix sum
+// lays out the offsets, and a second pass fills and sorts each lab in place.
+DurationsCsr generate_bulk_instance(int L, int max_students, int max_duration, uint64_t seed, int instance_id, int num_threads) {
+    if (num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+    DurationsCsr csr;
+    csr.offsets.assign(L + 1, 0);
+
+    auto for_each_lab = [&](auto&& body) {
+        vector<thread> pool;
+        for (int w = 0; w < num_threads; ++w) {
+            pool.emplace_back([&, w] {
+                int first = (long long)L * w / num_threads;
+                int last = (long long)L * (w + 1) / num_threads;
+                for (int l = first; l < last; ++l) body(l);
+            });
+        }
+        for (auto& th : pool) th.join();
+    };
+
+    for_each_lab([&](int l) {
+        CounterRng rng(seed, instance_id, l);
+        csr.offsets[l + 1] = draw_lab_size(rng, max_students);
+    });
+    for (int l = 0; l < L; ++l)
+        csr.offsets[l + 1] += csr.offsets[l];
+
+    csr.durations.resize(csr.offsets[L]);
+    for_each_lab([&](int l) {
+        CounterRng rng(seed, instance_id, l);
+        draw_lab_size(rng, max_students); // skip the size draw
+        draw_lab_durations(rng, max_duration, csr.durations.data() + csr.offsets[l],
+                           csr.offsets[l + 1] - csr.offsets[l]);
+    });
+    return csr;
+}
+
+// Per-inspection aggregates over the labs that still have an (i+1)-th student:
+// the feasibility bound max_l finish_l(i+1), how many labs take part and the
+// sum of their finish times. For a feasible time t (t >= required[i]) no clamp
+// applies, so the idle of inspection i is count[i] * t - sum[i].
+struct IndexBounds {
+    vector<int> required;
+    vector<int> count;
+    vector<long long> sum;
+};
+
+IndexBounds compute_index_bounds(const Instance& inst, int C) {
+    IndexBounds b;
+    b.required.assign(C, 0);
+    b.count.assign(C, 0);
+    b.sum.assign(C, 0);
+    for (int l = 0; l < inst.L; ++l) {
+        int k = min(C, inst.students[l]);
+        for (int i = 0; i < k; ++i) {
+            int ft = finish_time(inst, l, i + 1);
+            b.required[i] = max(b.required[i], ft);
+            ++b.count[i];
+            b.sum[i] += ft;
+        }
     }
+    return b;
+}
 
-    // collect all finish‐time events ≤ T
-    vector<int> events;
-    for (int l = 0; l < 2; ++l)
-      for (int k = 1; k < (int)finish[l].size(); ++k)
-        if (finish[l][k] <= T)
-          events.push_back(finish[l][k]);
+// Lexicographic brute force with C fixed at compile time. walk<I> is the loop
+// over position I; the recursion inlines into C plain nested loops over
+// std::array state, with each position's requirement and partial idle
+// settled once per loop level instead of once per combination.
+template <int C>
+struct FixedBruteForce {
+    const int* events = nullptr;
+    int N = 0;
+    array<int, C> required;
+    array<long long, C> count;
+    array<long long, C> sum;
+    array<int, C> current;
+    array<int, C> best;
+    long long best_idle = numeric_limits<long long>::max();
 
-    sort(events.begin(), events.end());
-    events.erase(unique(events.begin(), events.end()), events.end());
-    int N = events.size();
+    template <int I>
+    void walk(int from, long long partial) {
+        if constexpr (I == C) {
+            INSTRUMENT_COUNT(combinations, 1);
+            INSTRUMENT_COUNT(feasible, 1);
+            if (partial < best_idle) {
+                INSTRUMENT_COUNT(improvements, 1);
+                best_idle = partial;
+                best = current;
+            }
+        } else {
+            for (int e = from; e <= N - C + I; ++e) {
+                int t = events[e];
+                if (t < required[I]) {
+                    // Every completion of this prefix is cut at once
+                    INSTRUMENT_COUNT(combinations, binomial(N - e - 1, C - I - 1));
+                    INSTRUMENT_COUNT(infeasible, binomial(N - e - 1, C - I - 1));
+                    continue;
+                }
+                current[I] = e;
+                walk<I + 1>(e + 1, partial + count[I] * t - sum[I]);
+            }
+        }
+    }
+};
+
+template <int C>
+vector<int> optimal_brute_force_fixed(const vector<int>& events, const IndexBounds& bounds) {
+    FixedBruteForce<C> bf;
+    bf.events = events.data();
+    bf.N = events.size();
+    for (int i = 0; i < C; ++i) {
+        bf.required[i] = bounds.required[i];
+        bf.count[i] = bounds.count[i];
+        bf.sum[i] = bounds.sum[i];
+    }
+    bf.template walk<0>(0, 0);
+    if (bf.best_idle == numeric_limits<long long>::max()) return {}; // no feasible schedule
+
+    vector<int> sol;
+    for (int e : bf.best) sol.push_back(events[e]);
+    return sol;
+}
 
-    // if not enough distinct events, fallback to evenly spaced
-    if (N < C) {
-      vector<int> fb;
-      for (int i = 1; i <= C; ++i)
-        fb.push_back(i * T / (C+1));
-      return fb;
+// Dispatches a runtime C in 1..MAX_SPECIALIZED_C to its specialization. Same
+// result as optimal_brute_force_generic.
+vector<int> optimal_brute_force_specialized(const Instance& inst, int C) {
+    vector<int> events = collect_events(inst);
+    if ((int)events.size() < C) return {}; // not enough options to pick from
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    switch (C) {
+    case 1: return optimal_brute_force_fixed<1>(events, bounds);
+    case 2: return optimal_brute_force_fixed<2>(events, bounds);
+    case 3: return optimal_brute_force_fixed<3>(events, bounds);
+    case 4: return optimal_brute_force_fixed<4>(events, bounds);
+    case 5: return optimal_brute_force_fixed<5>(events, bounds);
+    case 6: return optimal_brute_force_fixed<6>(events, bounds);
+    case 7: return optimal_brute_force_fixed<7>(events, bounds);
+    case 8: return optimal_brute_force_fixed<8>(events, bounds);
+    default: return optimal_brute_force_generic(inst, C);
     }
+}
+
+// Exact DP over the sorted events for any number of labs, O(L·C + C·N).
+// best[c][e] is the least idle of inspections c..C-1 using events e..N-1 only.
+// Ties prefer taking the earlier event, so the reconstructed schedule is the
+// lexicographically smallest optimum, the same one optimal_brute_force returns.
+vector<int> optimal_dp(const Instance& inst, int C) {
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C) return {}; // not enough options to pick from
 
-    const int INF = numeric_limits<int>::max() / 2;
-    vector<vector<int>> dp(C+1, vector<int>(N+1, INF));
-    vector<vector<bool>> take(C+1, vector<bool>(N+1, false));
+    IndexBounds bounds = compute_index_bounds(inst, C);
 
-    // base case
+    const long long INF = numeric_limits<long long>::max() / 2;
+    vector<vector<long long>> best(C + 1, vector<long long>(N + 1, INF));
+    vector<vector<bool>> take(C, vector<bool>(N, false));
+
+    // base case: nothing left to schedule
     for (int e = 0; e <= N; ++e)
-      dp[0][e] = 0;
+        best[C][e] = 0;
 
-    // fill DP
-    for (int c = 1; c <= C; ++c) {
-      for (int e = 1; e <= N; ++e) {
-        // skip event e-1
-        dp[c][e] = dp[c][e-1];
+    for (int c = C - 1; c >= 0; --c) {
+        for (int e = N - (C - c); e >= 0; --e) {
+            // skip event e
+            best[c][e] = best[c][e + 1];
 
-        // take event e-1 as the cth inspection
-        int t = events[e-1];
-        int req = max(finish[0][c], finish[1][c]);
-        if (t >= req) {
-          int idle = (t - finish[0][c]) + (t - finish[1][c]);
-          int cand = dp[c-1][e-1] + idle;
-          if (cand < dp[c][e]) {
-            dp[c][e] = cand;
-            take[c][e] = true;
-          }
+            // take event e as inspection c
+            int t = events[e];
+            if (t >= bounds.required[c] && best[c + 1][e + 1] < INF) {
+                long long cand = best[c + 1][e + 1] + bounds.count[c] * (long long)t - bounds.sum[c];
+                if (cand <= best[c][e]) {
+                    best[c][e] = cand;
+                    take[c][e] = true;
+                }
+            }
         }
-      }
     }
 
-    // backtrack
+    if (best[0][0] >= INF) return {}; // no feasible schedule
+
+    // walk forward along the preferred decisions
     vector<int> sol;
-    int c = C, e = N;
-    while (c > 0) {
-      if (take[c][e]) {
-        sol.push_back(events[e-1]);
-        --c; --e;
-      } else {
-        --e;
-      }
-    }
-    reverse(sol.begin(), sol.end());
-
-    // if somehow empty, fallback
-    if (sol.size() != (size_t)C) {
-      sol.clear();
-      for (int i = 1; i <= C; ++i)
-        sol.push_back(i * T / (C+1));
+    for (int c = 0, e = 0; c < C; ++e) {
+        if (take[c][e]) {
+            sol.push_back(events[e]);
+            ++c;
+        }
     }
     return sol;
 }
 
-int main() {
-    const int L = 3;        // Number of labs
-    const int C = 2;        // Number of inspections
-    const int D = 1;        // Days (for time horizon)
-    const int T = D * 24;   // Total available time
+// How optimal_dp_lean recovers the schedule from its rolling rows.
+//   BitPacked   one take bit per (inspection, event): C·N/8 bytes, one pass
+//   Hirschberg  divide and conquer on the inspections: O(N) memory; each
+//               level halves the positions, so about twice one pass's work
+//   Automatic   BitPacked while its matrix fits DP_TAKE_BUDGET, else Hirschberg
+enum class DpReconstruction { Automatic, BitPacked, Hirschberg };
 
-    srand(static_cast<unsigned>(time(nullptr)));
+const size_t DP_TAKE_BUDGET = size_t(64) << 20;
 
-    // Prepare CSV
-    ofstream csv("brute_force_runtime.csv");
-    csv << "Instance,N,C,Combinations,Runtime(us)\n";
-    ofstream heuristic_csv("approx_runtime.csv");
-    heuristic_csv << "Instance,C,Runtime(us)\n";
+// Hirschberg-style reconstruction. Positions [c0, c1) are placed in events
+// [e0, e1) by meeting a forward pass over the first half of the positions and
+// a backward pass over the second half at the best split event, then recursing
+// on both sides. The four rows are shared by every level of the recursion.
+struct HirschbergDp {
+    const vector<int>& events;
+    const IndexBounds& bounds;
+    int N;
+    vector<long long> forward, forward_next, backward, backward_next;
+    vector<int> pos;
+    bool feasible = true;
 
-    const int num_instances = 20; // Try 20 different instances
-    for (int instance_id = 1; instance_id <= num_instances; ++instance_id) {
-        
+    static constexpr long long INF = numeric_limits<long long>::max() / 2;
 
-        int max_students = rand() % 10 + 1;
-        int max_duration = rand() % 24 + 1;
+    HirschbergDp(const vector<int>& ev, const IndexBounds& b, int C)
+        : events(ev), bounds(b), N(ev.size()), forward(N + 1), forward_next(N + 1),
+          backward(N + 1), backward_next(N + 1), pos(C) {}
 
-        auto durations = generate_random_instance(L, max_students, max_duration);
+    // Idle of inspection c at event e, or INF if e is before its requirement
+    long long cost(int c, int e) const {
+        int t = events[e];
+        if (t < bounds.required[c]) return INF;
+        return bounds.count[c] * (long long)t - bounds.sum[c];
+    }
 
-        // Heuristic solution
-        auto start_heuristic = high_resolution_clock::now();
-        auto heuristic_times = schedule_inspections(durations, L, C, T);
-        int heuristic_idle = calculate_total_unoccupied_time(durations, heuristic_times);
-        auto end_heuristic = high_resolution_clock::now();
-        
-        long long heuristic_runtime = duration_cast<microseconds>(end_heuristic - start_heuristic).count();
-        heuristic_csv << instance_id << "," << C << "," << heuristic_runtime << "\n";
+    void solve(int c0, int c1, int e0, int e1) {
+        if (c0 == c1 || !feasible) return;
+        if (c1 - c0 == 1) {
+            long long best = INF;
+            for (int e = e0; e < e1; ++e) {
+                long long v = cost(c0, e);
+                if (v < best) {
+                    best = v;
+                    pos[c0] = e;
+                }
+            }
+            if (best >= INF) feasible = false;
+            return;
+        }
+        int mid = (c0 + c1) / 2;
 
+        // forward[e]: least idle of positions c0..mid-1 within events [e0, e)
+        fill(forward.begin() + e0, forward.begin() + e1 + 1, 0);
+        for (int c = c0; c < mid; ++c) {
+            forward_next[e0] = INF;
+            for (int e = e0 + 1; e <= e1; ++e) {
+                long long v = forward_next[e - 1];
+                long long v_cost = cost(c, e - 1);
+                if (forward[e - 1] < INF && v_cost < INF) v = min(v, forward[e - 1] + v_cost);
+                forward_next[e] = v;
+            }
+            swap(forward, forward_next);
+        }
 
-        // Brute-force solution (event collection)
-        auto events = vector<int>();
-        for (int l = 0; l < L; ++l) {
-            for (int k = 1; k <= (int)durations[l].size(); ++k) {
-                int ft = compute_finish_time(durations[l], k);
-                if (ft <= T) events.push_back(ft);
+        // backward[e]: least idle of positions mid..c1-1 within events [e, e1)
+        fill(backward.begin() + e0, backward.begin() + e1 + 1, 0);
+        for (int c = c1 - 1; c >= mid; --c) {
+            backward_next[e1] = INF;
+            for (int e = e1 - 1; e >= e0; --e) {
+                long long v = backward_next[e + 1];
+                long long v_cost = cost(c, e);
+                if (backward[e + 1] < INF && v_cost < INF) v = min(v, backward[e + 1] + v_cost);
+                backward_next[e] = v;
             }
+            swap(backward, backward_next);
         }
-        sort(events.begin(), events.end());
-        events.erase(unique(events.begin(), events.end()), events.end());
 
-        int N = events.size();
+        // The earliest best split keeps the lexicographically smallest optimum
+        int split = -1;
+        long long best = INF;
+        for (int e = e0; e <= e1; ++e) {
+            if (forward[e] >= INF || backward[e] >= INF) continue;
+            if (forward[e] + backward[e] < best) {
+                best = forward[e] + backward[e];
+                split = e;
+            }
+        }
+        if (split < 0) {
+            feasible = false;
+            return;
+        }
+        solve(c0, mid, e0, split);
+        solve(mid, c1, split, e1);
+    }
+};
+
+// optimal_dp with rolling rows: the same schedule in O(N) DP memory (plus the
+// bit-packed take matrix when that reconstruction is used). peak_bytes, if
+// given, receives the bytes held by the DP rows and reconstruction state.
+vector<int> optimal_dp_lean(const Instance& inst, int C, DpReconstruction mode, size_t* peak_bytes) {
+    if (peak_bytes) *peak_bytes = 0;
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C) return {}; // not enough options to pick from
+    if (C == 0) return {};
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    size_t words = (N + 63) / 64;
+    size_t take_bytes = (size_t)C * words * sizeof(uint64_t);
+    if (mode == DpReconstruction::Automatic)
+        mode = take_bytes <= DP_TAKE_BUDGET ? DpReconstruction::BitPacked : DpReconstruction::Hirschberg;
 
-        auto binomial = [](int n, int k) -> long long {
-            if (k > n) return 0;
-            long long res = 1;
-            for (int i = 1; i <= k; ++i) {
-                res *= (n - i + 1);
-                res /= i;
+    vector<int> sol;
+    if (mode == DpReconstruction::Hirschberg) {
+        HirschbergDp dp(events, bounds, C);
+        dp.solve(0, C, 0, N);
+        if (peak_bytes) *peak_bytes = 4 * (N + 1) * sizeof(long long) + C * sizeof(int);
+        if (!dp.feasible) return {}; // no feasible schedule
+        for (int e : dp.pos) sol.push_back(events[e]);
+        return sol;
+    }
+
+    // The suffix DP of optimal_dp, keeping only rows c and c + 1
+    const long long INF = numeric_limits<long long>::max() / 2;
+    vector<long long> next(N + 1, 0), cur(N + 1);
+    vector<uint64_t> take((size_t)C * words, 0);
+    if (peak_bytes) *peak_bytes = 2 * (N + 1) * sizeof(long long) + take_bytes;
+
+    for (int c = C - 1; c >= 0; --c) {
+        fill(cur.begin(), cur.end(), INF);
+        uint64_t* take_row = take.data() + (size_t)c * words;
+        for (int e = N - (C - c); e >= 0; --e) {
+            // skip event e
+            cur[e] = cur[e + 1];
+
+            // take event e as inspection c
+            int t = events[e];
+            if (t >= bounds.required[c] && next[e + 1] < INF) {
+                long long cand = next[e + 1] + bounds.count[c] * (long long)t - bounds.sum[c];
+                if (cand <= cur[e]) {
+                    cur[e] = cand;
+                    take_row[e >> 6] |= 1ULL << (e & 63);
+                }
             }
-            return res;
-            };
-        long long combinations = binomial(N, C);
+        }
+        swap(cur, next);
+    }
+
+    if (next[0] >= INF) return {}; // no feasible schedule
+
+    // walk forward along the preferred decisions
+    for (int c = 0, e = 0; c < C; ++e) {
+        if (take[(size_t)c * words + (e >> 6)] >> (e & 63) & 1) {
+            sol.push_back(events[e]);
+            ++c;
+        }
+    }
+    return sol;
+}
+
+// optimal_dp for very large N in O(N + C log N). Written forward, the DP is
+//   best[c][e] = cost(c, e) + min over e' < e of best[c - 1][e']
+// with the inner minimum kept as a running prefix minimum. A feasible cost
+// count[c] * t - sum[c] never decreases with t, and best[c - 1] is
+// nondecreasing from its first finite entry on, so every prefix minimum is
+// attained at the earliest feasible event. The optimum is therefore the chain
+// of earliest feasible events, each after its predecessor: the lower bound
+// branch and bound starts from. No other feasible schedule is pointwise
+// earlier, so this is also the lexicographically smallest optimum that
+// optimal_dp returns.
+vector<int> optimal_dp_monotone(const Instance& inst, int C) {
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C) return {}; // not enough options to pick from
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    vector<int> sol(C);
+    for (int c = 0, e = 0; c < C; ++c, ++e) {
+        e = max(e, (int)(lower_bound(events.begin(), events.end(), bounds.required[c]) - events.begin()));
+        if (e > N - (C - c)) return {}; // no feasible schedule
+        sol[c] = events[e];
+    }
+    return sol;
+}
+
+// Optimal schedules for every inspection count 1..Cmax from one solve.
+// Inspection c's requirement does not depend on how many follow it, so the
+// earliest-feasible chain of optimal_dp_monotone is the same for every C and
+// the optimum for C = c is its first c events.
+struct CapacityCurve {
+    vector<int> chain;          // chain[0..c-1] is the optimal schedule for c
+    vector<long long> idle;     // idle[c - 1]: optimal idle with c inspections
+
+    // Largest C with a feasible schedule
+    int max_feasible() const { return idle.size(); }
 
-        // Time brute-force
-        auto start_opt = high_resolution_clock::now();
-        auto optimal_times = optimal_brute_force(durations, L, C, T);
-        auto end_opt = high_resolution_clock::now();
-        long long runtime_us = duration_cast<microseconds>(end_opt - start_opt).count();
+    vector<int> times(int c) const {
+        if (c < 0 || c > max_feasible()) return {};
+        return vector<int>(chain.begin(), chain.begin() + c);
+    }
+
+    // Idle added by inspection c: idle(c) - idle(c - 1). Never negative, as
+    // every extra inspection makes the labs it reaches wait a little longer.
+    long long marginal(int c) const {
+        return idle[c - 1] - (c > 1 ? idle[c - 2] : 0);
+    }
+};
+
+// Stops at the first inspection count with no feasible schedule; every
+// larger count is infeasible too.
+CapacityCurve optimal_all_counts(const Instance& inst, int max_C) {
+    CapacityCurve curve;
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    IndexBounds bounds = compute_index_bounds(inst, max_C);
+    long long total = 0;
+    for (int c = 0, e = 0; c < max_C; ++c, ++e) {
+        e = max(e, (int)(lower_bound(events.begin(), events.end(), bounds.required[c]) - events.begin()));
+        if (e >= N) break;
+        int t = events[e];
+        total += bounds.count[c] * (long long)t - bounds.sum[c];
+        curve.chain.push_back(t);
+        curve.idle.push_back(total);
+    }
+    return curve;
+}
 
-        if (!optimal_times.empty()) {
-            int optimal_idle = calculate_total_unoccupied_time(durations, optimal_times);
-            cout << "\nInstance " << instance_id << "\n";
-            cout << "Optimal solution:\nTimes: ";
-            for (int t : optimal_times) cout << t << " ";
-            cout << "\nIdle time: " << optimal_idle << "\n";
+// Number of k-combinations of n items, saturating at LLONG_MAX.
+long long binomial(int n, int k) {
+    if (k < 0 || k > n) return 0;
+    k = min(k, n - k);
+    long long res = 1;
+    for (int i = 1; i <= k; ++i) {
+        long long factor = n - i + 1;
+        if (res > numeric_limits<long long>::max() / factor)
+            return numeric_limits<long long>::max();
+        res = res * factor / i; // exact: res * factor is C(n, i) * i
+    }
+    return res;
+}
 
-            cout << "\nComparison:\n";
-            cout << "Heuristic idle: " << heuristic_idle << "\n";
-            cout << "Optimal idle: " << optimal_idle << "\n";
-            cout << "Difference: " << (heuristic_idle - optimal_idle)
-                << " (" << 100.0 * (heuristic_idle - optimal_idle) / optimal_idle << "% worse)\n";
+// Writes the combination of lexicographic rank `rank` (combinatorial number
+// system) into indices[0..C-1].
+void unrank_combination(long long rank, int N, int C, vector<int>& indices) {
+    int x = 0;
+    for (int i = 0; i < C; ++i) {
+        while (true) {
+            long long block = binomial(N - x - 1, C - i - 1);
+            if (rank < block) break;
+            rank -= block;
+            ++x;
+        }
+        indices[i] = x++;
+    }
+}
 
-            // Write to CSV
-         
-       csv << instance_id << "," << N << "," << C << "," << combinations << "," << runtime_us << "\n";
-       // -- DP solution on the first two labs --
-vector<vector<int>> two = { durations[0], durations[1] };
-vector<int> dp_times = optimal_dp_2labs(two, C, T);
-int dp_idle = calculate_total_unoccupied_time(two, dp_times);
+// Best (idle, rank) pair found by one worker; smaller rank wins ties so the
+// reduction reproduces the serial walk's first-found optimum.
+struct BruteForceBest {
+    long long idle = numeric_limits<long long>::max();
+    long long rank = numeric_limits<long long>::max();
+    vector<int> schedule;
+};
 
-cout << "\nDP-2labs solution:\n";
-cout << " Times: ";
-for (int t : dp_times) cout << t << " ";
-cout << "\n Idle time: " << dp_idle << "\n";
+// Exhaustively checks the combinations with ranks [first, last).
+void brute_force_rank_range(const vector<int>& events, const IndexBounds& bounds, int C,
+                            long long first, long long last, BruteForceBest& best) {
+    int N = events.size();
+    vector<int> indices(C);
+    unrank_combination(first, N, C, indices);
 
+    for (long long rank = first; rank < last; ++rank) {
+        bool feasible = true;
+        long long idle = 0;
+        for (int i = 0; i < C; ++i) {
+            int t = events[indices[i]];
+            if (t < bounds.required[i]) {
+                feasible = false;
+                break;
+            }
+            idle += bounds.count[i] * (long long)t - bounds.sum[i];
         }
-        else {
-            cout << "\nInstance " << instance_id << ": No valid optimal schedule found.\n";
+        INSTRUMENT_COUNT(combinations, 1);
+        INSTRUMENT_COUNT(feasible, feasible);
+        INSTRUMENT_COUNT(infeasible, !feasible);
+        if (feasible && idle < best.idle) {
+            INSTRUMENT_COUNT(improvements, 1);
+            best.idle = idle;
+            best.rank = rank;
+            best.schedule.resize(C);
+            for (int i = 0; i < C; ++i)
+                best.schedule[i] = events[indices[i]];
         }
+
+        // Generate next combination
+        int i = C - 1;
+        while (i >= 0 && indices[i] == N - C + i) --i;
+        if (i < 0) break;
+        ++indices[i];
+        for (int j = i + 1; j < C; ++j)
+            indices[j] = indices[j - 1] + 1;
     }
+}
+
+// Multi-threaded optimal_brute_force. The C(N, C) ranks are split evenly across
+// workers; each worker consumes its own range in chunks from the front and,
+// once empty, steals the back half of the largest remaining range. The result
+// is identical to the serial path. num_threads <= 0 uses every core.
+vector<int> optimal_brute_force_parallel(const Instance& inst, int C, int num_threads) {
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C) return {}; // not enough options to pick from
 
-    csv.close();
-    heuristic_csv.close();
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    long long total = binomial(N, C);
 
-    cout << "\nFinished running " << num_instances << " instances.\n";
+    if (num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+    num_threads = (int)min<long long>(num_threads, total);
+    const long long chunk = max(1024LL, total / (num_threads * 64LL));
 
-   
-    return 0;
+    struct RankRange {
+        mutex m;
+        long long next = 0, end = 0;
+    };
+    vector<RankRange> ranges(num_threads);
+    for (int w = 0; w < num_threads; ++w) {
+        ranges[w].next = total / num_threads * w;
+        ranges[w].end = (w + 1 == num_threads) ? total : total / num_threads * (w + 1);
+    }
+
+    vector<BruteForceBest> results(num_threads);
+    auto worker = [&](int self) {
+        RankRange& own = ranges[self];
+        while (true) {
+            long long first, last;
+            {
+                lock_guard<mutex> lock(own.m);
+                first = own.next;
+                last = min(own.end, first + chunk);
+                own.next = last;
+            }
+            if (first < last) {
+                brute_force_rank_range(events, bounds, C, first, last, results[self]);
+                continue;
+            }
+
+            // Own range is exhausted: steal the back half of the largest one
+            int victim = -1;
+            long long most = 0;
+            for (int w = 0; w < num_threads; ++w) {
+                if (w == self) continue;
+                lock_guard<mutex> lock(ranges[w].m);
+                if (ranges[w].end - ranges[w].next > most) {
+                    most = ranges[w].end - ranges[w].next;
+                    victim = w;
+                }
+            }
+            if (victim < 0) return;
+
+            long long stolen_first, stolen_last;
+            {
+                lock_guard<mutex> lock(ranges[victim].m);
+                long long left = ranges[victim].end - ranges[victim].next;
+                if (left <= 0) continue; // drained meanwhile, look again
+                stolen_last = ranges[victim].end;
+                stolen_first = ranges[victim].next + (left + 1) / 2;
+                if (left == 1) stolen_first = ranges[victim].next;
+                ranges[victim].end = stolen_first;
+            }
+            lock_guard<mutex> lock(own.m);
+            own.next = stolen_first;
+            own.end = stolen_last;
+        }
+    };
+
+    vector<thread> pool;
+    for (int w = 1; w < num_threads; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& th : pool) th.join();
+
+    // Deterministic reduction: least idle, then least rank
+    BruteForceBest best;
+    for (auto& r : results) {
+        if (r.idle < best.idle || (r.idle == best.idle && r.rank < best.rank))
+            best = r;
+    }
+    return best.schedule;
 }
 
+// Depth-first branch and bound over the same lexicographic combination tree as
+// optimal_brute_force. Position i only ranges over events >= required[i], and
+// a subtree is cut as soon as its partial idle plus an admissible bound on the
+// remaining positions reaches the incumbent. The search stops early once the
+// incumbent meets the global lower bound, or once the optional deadline passes.
+struct BranchAndBound {
+    const vector<int>& events;
+    const IndexBounds& bounds;
+    int C;
+    int N;
+    vector<int> first;          // first event index allowed at each position
+    vector<int> path;           // event indices of the current partial schedule
+    vector<int> best_path;
+    long long best_idle = numeric_limits<long long>::max();
+    long long global_lower_bound = 0;
+    long long nodes = 0;
+    bool done = false;
+    bool timed_out = false;
+    bool has_deadline = false;
+    steady_clock::time_point deadline;
+
+    BranchAndBound(const vector<int>& ev, const IndexBounds& b, int c)
+        : events(ev), bounds(b), C(c), N(ev.size()), first(c), path(c) {
+        for (int i = 0; i < C; ++i)
+            first[i] = lower_bound(events.begin(), events.end(), bounds.required[i]) - events.begin();
+    }
+
+    long long cost(int i, int e) const {
+        return bounds.count[i] * (long long)events[e] - bounds.sum[i];
+    }
+
+    // Idle of positions i..C-1 when each takes its earliest event at or after
+    // index s. Every position's idle grows with its time, so no completion of
+    // the partial schedule can do better. Returns -1 if none fits.
+    long long lower_bound_from(int i, int s) const {
+        long long lb = 0;
+        for (int j = i; j < C; ++j, ++s) {
+            s = max(s, first[j]);
+            if (s > N - (C - j)) return -1;
+            lb += cost(j, s);
+        }
+        return lb;
+    }
+
+    void search(int i, int s, long long partial) {
+        // The clock is read once every 1024 nodes
+        if ((++nodes & 1023) == 0 && has_deadline && steady_clock::now() >= deadline)
+            timed_out = done = true;
+        if (done) return;
+        INSTRUMENT_COUNT(combinations, 1);
+        if (i == C) {
+            INSTRUMENT_COUNT(feasible, 1);
+            if (partial < best_idle) {
+                INSTRUMENT_COUNT(improvements, 1);
+                best_idle = partial;
+                best_path = path;
+                done = (best_idle == global_lower_bound);
+            }
+            return;
+        }
+        for (int e = max(s, first[i]); e <= N - (C - i) && !done; ++e) {
+            long long rest = lower_bound_from(i + 1, e + 1);
+            if (rest < 0) {
+                INSTRUMENT_COUNT(infeasible, 1);
+                break;
+            }
+            // cost and bound only grow with e, so later events cannot do better
+            if (partial + cost(i, e) + rest >= best_idle) break;
+            path[i] = e;
+            search(i + 1, e + 1, partial + cost(i, e));
+        }
+    }
+};
+
+vector<int> optimal_branch_and_bound(const Instance& inst, int C, long long* nodes_visited) {
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (nodes_visited) *nodes_visited = 0;
+    if (N < C) return {}; // not enough options to pick from
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    BranchAndBound bb(events, bounds, C);
+    bb.global_lower_bound = bb.lower_bound_from(0, 0);
+    if (bb.global_lower_bound < 0) return {}; // no feasible schedule
+
+    bb.search(0, 0, 0);
+    if (nodes_visited) *nodes_visited = bb.nodes;
 
+    vector<int> sol;
+    for (int e : bb.best_path) sol.push_back(events[e]);
+    return sol;
+}
+
+// Brute force over the revolving-door Gray code (Knuth, TAOCP 7.2.1.3,
+// Algorithm R). The idle sum and the number of positions below their
+// requirement are kept as running totals and patched for the one or two
+// positions each step changes. Ties are broken towards the lexicographically
+// smaller schedule, so the result equals the lexicographic walk.
+vector<int> optimal_brute_force_revolving_door(const Instance& inst, int C) {
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C) return {}; // not enough options to pick from
+    if (C == 0) return {};
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+
+    // c[1..C] are the chosen event indices in increasing order, c[C+1] = N
+    vector<int> c(C + 2);
+    for (int j = 1; j <= C; ++j) c[j] = j - 1;
+    c[C + 1] = N;
+
+    long long idle = 0;
+    int violations = 0;
+    auto contribution = [&](int j, int sign) {
+        int t = events[c[j]];
+        idle += sign * (bounds.count[j - 1] * (long long)t - bounds.sum[j - 1]);
+        if (t < bounds.required[j - 1]) violations += sign;
+    };
+    auto set_position = [&](int j, int e) {
+        contribution(j, -1);
+        c[j] = e;
+        contribution(j, +1);
+    };
+    for (int j = 1; j <= C; ++j) contribution(j, +1);
+
+    vector<int> best_indices;
+    long long best_idle = numeric_limits<long long>::max();
+
+    while (true) {
+        // R2. Visit
+        INSTRUMENT_COUNT(combinations, 1);
+        INSTRUMENT_COUNT(feasible, violations == 0);
+        INSTRUMENT_COUNT(infeasible, violations != 0);
+        if (violations == 0 && (idle < best_idle ||
+            (idle == best_idle && lexicographical_compare(c.begin() + 1, c.begin() + C + 1,
+                                                          best_indices.begin(), best_indices.end())))) {
+            INSTRUMENT_COUNT(improvements, 1);
+            best_idle = idle;
+            best_indices.assign(c.begin() + 1, c.begin() + C + 1);
+        }
+
+        // R3. Easy case
+        if (C % 2 == 1) {
+            if (c[1] + 1 < c[2]) { set_position(1, c[1] + 1); continue; }
+        } else {
+            if (c[1] > 0) { set_position(1, c[1] - 1); continue; }
+        }
+
+        int j = 2;
+        bool decrease = (C % 2 == 1);
+        bool moved = false;
+        while (j <= C) {
+            if (decrease) {
+                // R4. Try to decrease c[j]
+                if (c[j] >= j) {
+                    set_position(j, c[j - 1]);
+                    set_position(j - 1, j - 2);
+                    moved = true;
+                    break;
+                }
+            } else {
+                // R5. Try to increase c[j]
+                if (c[j] + 1 < c[j + 1]) {
+                    set_position(j - 1, c[j]);
+                    set_position(j, c[j] + 1);
+                    moved = true;
+                    break;
+                }
+            }
+            ++j;
+            decrease = !decrease;
+        }
+        if (!moved) break; // R6. Terminate
+    }
+
+    vector<int> sol;
+    for (int e : best_indices) sol.push_back(events[e]);
+    return sol;
+}
+
+//--------------------------local search-------------------------
+// Best idle over all restarts after a number of moves per restart.
+struct TracePoint {
+    long long iterations = 0;
+    long long best_idle = 0;
+};
+
+struct LocalSearchResult {
+    vector<int> schedule;       // Empty when no feasible schedule exists
+    long long idle = 0;
+    long long start_idle = 0;   // Idle of the repaired heuristic schedule
+    vector<TracePoint> trace;
+};
+
+// One annealing chain over feasible schedules: increasing event indices with
+// pos[i] >= first[i]. On them the idle of inspection i is count[i] * t - sum[i]
+// with no clamp, so every move is priced in O(1).
+struct AnnealingChain {
+    const vector<int>& events;
+    const IndexBounds& bounds;
+    const vector<int>& first;
+    int C;
+    int N;
+    vector<int> pos;
+    long long idle = 0;
+    vector<int> best_pos;
+    long long best_idle = 0;
+
+    AnnealingChain(const vector<int>& ev, const IndexBounds& b, const vector<int>& f, const vector<int>& start)
+        : events(ev), bounds(b), first(f), C(f.size()), N(ev.size()), pos(start) {
+        for (int i = 0; i < C; ++i)
+            idle += cost(i, pos[i]);
+        best_pos = pos;
+        best_idle = idle;
+    }
+
+    long long cost(int i, int e) const {
+        return bounds.count[i] * (long long)events[e] - bounds.sum[i];
+    }
+
+    // Whether inspection i may sit at event e given its neighbours
+    bool fits(int i, int e) const {
+        return e >= first[i] && (i == 0 || e > pos[i - 1]) && e < (i + 1 == C ? N : pos[i + 1]);
+    }
+
+    // Shift: inspection i moves to the neighbouring event in direction dir.
+    bool shift_feasible(int i, int dir) const {
+        return fits(i, pos[i] + dir);
+    }
+
+    long long shift_delta(int i, int dir) const {
+        return cost(i, pos[i] + dir) - cost(i, pos[i]);
+    }
+
+    // Block shift: inspections i and i + 1 move together by one event. The
+    // leading one moves first, so each only has to clear the other's old spot.
+    bool block_feasible(int i, int dir) const {
+        if (pos[i] + dir < first[i] || pos[i + 1] + dir < first[i + 1]) return false;
+        return dir > 0 ? pos[i + 1] + 1 < (i + 2 == C ? N : pos[i + 2])
+                       : (i == 0 ? 0 : pos[i - 1] + 1) <= pos[i] - 1;
+    }
+
+    long long block_delta(int i, int dir) const {
+        return shift_delta(i, dir) + shift_delta(i + 1, dir);
+    }
+
+    void apply(int i, int dir, int width, long long delta) {
+        for (int k = 0; k < width; ++k) pos[i + k] += dir;
+        idle += delta;
+        if (idle < best_idle) {
+            best_idle = idle;
+            best_pos = pos;
+        }
+    }
+};
+
+// Repairs a heuristic schedule into the feasible set: inspection i moves to the
+// first event at or after its time, its requirement and its predecessor.
+// Falls back to the earliest feasible chain when the repair runs out of
+// events. Returns event indices, or an empty vector if nothing is feasible.
+vector<int> repair_schedule(const vector<int>& events, const vector<int>& first, const vector<int>& times) {
+    int C = first.size();
+    int N = events.size();
+    vector<int> pos(C);
+    bool repaired = true;
+    for (int i = 0; i < C && repaired; ++i) {
+        int t = i < (int)times.size() ? times[i] : 0;
+        int e = max(first[i], (int)(lower_bound(events.begin(), events.end(), t) - events.begin()));
+        if (i > 0) e = max(e, pos[i - 1] + 1);
+        if (e > N - (C - i)) repaired = false;
+        else pos[i] = e;
+    }
+    if (repaired) return pos;
+
+    for (int i = 0, s = 0; i < C; ++i, ++s) {
+        s = max(s, first[i]);
+        if (s > N - (C - i)) return {};
+        pos[i] = s;
+    }
+    return pos;
+}
+
+// Improves the schedule_inspections output by simulated annealing with
+// restarts. Moves shift one inspection, or two adjacent ones together, to the
+// neighbouring event on either side; inspections keep their chronological
+// order, so exchanging two inspections' events is never feasible. Each
+// restart starts from the repaired heuristic schedule, cools geometrically
+// over `iterations` moves and draws from its own counter-based stream, so the
+// result does not depend on how the restarts are spread over threads.
+// num_threads <= 0 uses every core.
+LocalSearchResult improve_local_search(const Instance& inst, int C, int restarts, long long iterations,
+                                       int num_threads, uint64_t seed) {
+    LocalSearchResult result;
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C || C <= 0 || restarts <= 0) return result;
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    vector<int> first(C);
+    for (int i = 0; i < C; ++i)
+        first[i] = lower_bound(events.begin(), events.end(), bounds.required[i]) - events.begin();
+
+    vector<int> start = repair_schedule(events, first, schedule_inspections(inst, C));
+    if (start.empty()) return result; // no feasible schedule
+
+    // Starting temperature: the mean cost of moving an inspection by one event
+    double mean_count = accumulate(bounds.count.begin(), bounds.count.end(), 0.0) / C;
+    double mean_gap = N > 1 ? (double)(events[N - 1] - events[0]) / (N - 1) : 1.0;
+    const double initial_temperature = max(1.0, mean_count * mean_gap);
+    const double final_temperature = 1e-3;
+    const double cooling = pow(final_temperature / initial_temperature, 1.0 / max(1LL, iterations));
+
+    // Trace roughly 64 checkpoints plus the final state
+    const long long trace_every = max(1LL, iterations / 64);
+    const int checkpoints = (int)((iterations + trace_every - 1) / trace_every);
+
+    struct RestartResult {
+        vector<int> best_pos;
+        long long best_idle = 0;
+        vector<long long> trace;
+    };
+    vector<RestartResult> runs(restarts);
+
+    auto run = [&](int r) {
+        // Instance 0 is never generated; counting down from its last streams
+        // keeps restarts clear of both instance data and run_online's stream
+        CounterRng rng(seed, 0, PARAMS_STREAM - 1 - r);
+        AnnealingChain chain(events, bounds, first, start);
+        double temperature = initial_temperature;
+        RestartResult& out = runs[r];
+        auto step = [&]() {
+            int dir = (rng.next() & 1) ? 1 : -1;
+            bool block = C > 1 && (rng.next() & 1);
+            int i = rng.uniform(0, C - 1 - block);
+            if (block ? !chain.block_feasible(i, dir) : !chain.shift_feasible(i, dir)) return;
+            long long delta = block ? chain.block_delta(i, dir) : chain.shift_delta(i, dir);
+
+            // Metropolis acceptance
+            double u = (rng.next() >> 11) * 0x1.0p-53;
+            if (delta > 0 && u >= exp(-delta / temperature)) return;
+            chain.apply(i, dir, block ? 2 : 1, delta);
+        };
+        for (long long it = 1; it <= iterations; ++it, temperature *= cooling) {
+            step();
+            if (it % trace_every == 0 || it == iterations) out.trace.push_back(chain.best_idle);
+        }
+        out.best_pos = chain.best_pos;
+        out.best_idle = chain.best_idle;
+    };
+
+    if (num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+    num_threads = min(num_threads, restarts);
+    atomic<int> next_restart(0);
+    auto worker = [&]() {
+        for (int r; (r = next_restart.fetch_add(1)) < restarts;) run(r);
+    };
+    vector<thread> pool;
+    for (int w = 1; w < num_threads; ++w) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    // Deterministic reduction: least idle, then lowest restart
+    int best = 0;
+    for (int r = 1; r < restarts; ++r)
+        if (runs[r].best_idle < runs[best].best_idle) best = r;
+
+    // Feasible schedules are unclamped, so the chain's running idle is exactly
+    // calculate_total_unoccupied_time, without its int range
+    for (int e : runs[best].best_pos) result.schedule.push_back(events[e]);
+    result.idle = runs[best].best_idle;
+    for (int i = 0; i < C; ++i)
+        result.start_idle += bounds.count[i] * (long long)events[start[i]] - bounds.sum[i];
+
+    for (int k = 0; k < checkpoints; ++k) {
+        TracePoint p;
+        p.iterations = min(iterations, (k + 1) * trace_every);
+        p.best_idle = runs[0].trace[k];
+        for (int r = 1; r < restarts; ++r) p.best_idle = min(p.best_idle, runs[r].trace[k]);
+        result.trace.push_back(p);
+    }
+    return result;
+}
+
+// Local search on instance 1 of seed with the given parameters, against the
+// heuristic it starts from and the DP optimum. The trace goes to stdout as CSV.
+void run_local_search(int L, int C, int T, int max_students, int max_duration,
+                      int restarts, long long iterations, int num_threads, uint64_t seed) {
+    DurationsCsr csr = generate_bulk_instance(L, max_students, max_duration, seed, 1, num_threads);
+    Instance inst = build_instance(L, csr.offsets.data(), csr.durations.data(), T);
+
+    auto start = high_resolution_clock::now();
+    LocalSearchResult ls = improve_local_search(inst, C, restarts, iterations, num_threads, seed);
+    auto end = high_resolution_clock::now();
+    vector<int> optimal = optimal_dp(inst, C);
+
+    if (ls.schedule.empty()) {
+        cerr << "No feasible schedule\n";
+        return;
+    }
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    long long optimal_idle = 0;
+    for (int i = 0; i < C; ++i)
+        optimal_idle += bounds.count[i] * (long long)optimal[i] - bounds.sum[i];
+    cerr << "Repaired heuristic idle " << ls.start_idle
+         << ", local search " << ls.idle << " (" << duration_cast<milliseconds>(end - start).count()
+         << " ms), optimal " << optimal_idle << "\n";
+    cout << "Iterations,BestIdle\n";
+    for (const TracePoint& p : ls.trace)
+        cout << p.iterations << "," << p.best_idle << "\n";
+}
+
+//--------------------------anytime solving-------------------------
+struct AnytimeResult {
+    vector<int> schedule;       // Best found; empty when no feasible schedule exists
+    long long idle = 0;
+    long long lower_bound = 0;  // No feasible schedule has less idle
+    bool proven_optimal = false;
+    long long nodes = 0;        // Branch-and-bound nodes visited
+
+    // Remaining gap between the incumbent and the lower bound, in percent
+    double gap_percent() const {
+        return idle > 0 ? 100.0 * (idle - lower_bound) / idle : 0.0;
+    }
+};
+
+// Solves within a wall-clock budget. The incumbent is seeded with the repaired
+// heuristic schedule, then the branch and bound improves on it until it proves
+// optimality or the deadline passes; either way the best schedule found so far
+// is returned together with the bound it is measured against.
+AnytimeResult solve_anytime(const Instance& inst, int C, double budget_ms) {
+    auto deadline = steady_clock::now() + duration_cast<steady_clock::duration>(duration<double, milli>(budget_ms));
+    AnytimeResult result;
+    vector<int> events = collect_events(inst);
+    int N = events.size();
+    if (N < C || C <= 0) return result; // not enough options to pick from
+
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    BranchAndBound bb(events, bounds, C);
+    bb.global_lower_bound = bb.lower_bound_from(0, 0);
+    if (bb.global_lower_bound < 0) return result; // no feasible schedule
+
+    vector<int> start = repair_schedule(events, bb.first, schedule_inspections(inst, C));
+    bb.best_path = start;
+    bb.best_idle = 0;
+    for (int i = 0; i < C; ++i) bb.best_idle += bb.cost(i, start[i]);
+    bb.done = (bb.best_idle == bb.global_lower_bound);
+    bb.has_deadline = true;
+    bb.deadline = deadline;
+    if (!bb.done) bb.search(0, 0, 0);
+
+    for (int e : bb.best_path) result.schedule.push_back(events[e]);
+    result.idle = bb.best_idle;
+    result.lower_bound = bb.global_lower_bound;
+    result.proven_optimal = !bb.timed_out;
+    result.nodes = bb.nodes;
+    return result;
+}
+
+// Anytime solve of instance 1 of seed with the given parameters.
+void run_anytime(double budget_ms, int L, int C, int T, int max_students, int max_duration, uint64_t seed) {
+    DurationsCsr csr = generate_bulk_instance(L, max_students, max_duration, seed, 1, 0);
+    Instance inst = build_instance(L, csr.offsets.data(), csr.durations.data(), T);
+
+    auto start = steady_clock::now();
+    AnytimeResult r = solve_anytime(inst, C, budget_ms);
+    auto end = steady_clock::now();
+    if (r.schedule.empty()) {
+        cout << "No feasible schedule\n";
+        return;
+    }
+    cout << "Times: ";
+    for (int t : r.schedule) cout << t << " ";
+    cout << "\nIdle " << r.idle << ", lower bound " << r.lower_bound << ", gap " << r.gap_percent() << "%, "
+         << (r.proven_optimal ? "optimal" : "deadline reached") << " after " << r.nodes << " nodes in "
+         << duration_cast<microseconds>(end - start).count() << " us\n";
+}
+
+// Peak DP memory and runtime of the full-table optimal_dp against both
+// reconstructions of optimal_dp_lean on instance 1 of seed.
+void benchmark_dp_memory(int L, int C, int T, int max_students, int max_duration, uint64_t seed) {
+    DurationsCsr csr = generate_bulk_instance(L, max_students, max_duration, seed, 1, 0);
+    Instance inst = build_instance(L, csr.offsets.data(), csr.durations.data(), T);
+    size_t N = collect_events(inst).size();
+    cout << "L=" << L << " C=" << C << " T=" << T << " N=" << N << "\n";
+
+    // Full tables: (C + 1) x (N + 1) costs plus C vector<bool> rows
+    if (N < (size_t)C) {
+        cout << "Fewer events than inspections, nothing to solve\n";
+        return;
+    }
+    size_t full_bytes = (C + 1) * (N + 1) * sizeof(long long) + C * ((N + 63) / 64) * sizeof(uint64_t);
+    auto start = high_resolution_clock::now();
+    vector<int> reference = optimal_dp(inst, C);
+    auto end = high_resolution_clock::now();
+    cout << "Full table:  " << full_bytes << " bytes, "
+         << duration_cast<microseconds>(end - start).count() << " us\n";
+
+    for (DpReconstruction mode : { DpReconstruction::BitPacked, DpReconstruction::Hirschberg }) {
+        size_t bytes = 0;
+        start = high_resolution_clock::now();
+        vector<int> times = optimal_dp_lean(inst, C, mode, &bytes);
+        end = high_resolution_clock::now();
+        cout << (mode == DpReconstruction::BitPacked ? "Bit-packed:  " : "Hirschberg:  ") << bytes << " bytes ("
+             << (double)full_bytes / max<size_t>(1, bytes) << "x less), "
+             << duration_cast<microseconds>(end - start).count() << " us"
+             << (times == reference ? "" : ", DIFFERS from optimal_dp") << "\n";
+    }
+}
+
+// Runtime of the O(C·N) lean DP against optimal_dp_monotone on instance 1 of
+// seed, sized for event counts in the hundreds of thousands and beyond.
+void benchmark_dp_large(int L, int C, int T, int max_students, int max_duration, uint64_t seed) {
+    DurationsCsr csr = generate_bulk_instance(L, max_students, max_duration, seed, 1, 0);
+    Instance inst = build_instance(L, csr.offsets.data(), csr.durations.data(), T);
+    size_t N = collect_events(inst).size();
+    cout << "L=" << L << " C=" << C << " T=" << T << " N=" << N << "\n";
+
+    auto start = high_resolution_clock::now();
+    vector<int> reference = optimal_dp_lean(inst, C, DpReconstruction::Automatic, nullptr);
+    auto end = high_resolution_clock::now();
+    double lean_us = duration_cast<microseconds>(end - start).count();
+    cout << "Lean DP:     " << lean_us << " us\n";
+
+    start = high_resolution_clock::now();
+    vector<int> times = optimal_dp_monotone(inst, C);
+    end = high_resolution_clock::now();
+    double monotone_us = duration_cast<microseconds>(end - start).count();
+    cout << "Monotone DP: " << monotone_us << " us (" << lean_us / max(1.0, monotone_us) << "x faster)"
+         << (times == reference ? "" : ", DIFFERS from optimal_dp_lean") << "\n";
+    if (times.empty()) {
+        cout << "No feasible schedule\n";
+        return;
+    }
+    // At these sizes the idle overflows calculate_total_unoccupied_time's int
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    long long idle = 0;
+    for (int i = 0; i < C; ++i) idle += bounds.count[i] * (long long)times[i] - bounds.sum[i];
+    cout << "Idle " << idle << "\n";
+}
+
+// Optimal idle for every C up to max_C on instance 1 of seed, one row per C
+// with the idle the extra inspection adds.
+void run_capacity(int L, int max_C, int T, int max_students, int max_duration, uint64_t seed) {
+    DurationsCsr csr = generate_bulk_instance(L, max_students, max_duration, seed, 1, 0);
+    Instance inst = build_instance(L, csr.offsets.data(), csr.durations.data(), T);
+
+    auto start = high_resolution_clock::now();
+    CapacityCurve curve = optimal_all_counts(inst, max_C);
+    auto end = high_resolution_clock::now();
+
+    cout << "C,Idle,Marginal\n";
+    for (int c = 1; c <= curve.max_feasible(); ++c)
+        cout << c << "," << curve.idle[c - 1] << "," << curve.marginal(c) << "\n";
+    if (curve.max_feasible() < max_C)
+        cout << "No feasible schedule for C > " << curve.max_feasible() << "\n";
+    cout << "Times for C=" << curve.max_feasible() << ": ";
+    for (int t : curve.chain) cout << t << " ";
+    cout << "\nSolved C=1.." << max_C << " in " << duration_cast<microseconds>(end - start).count() << " us\n";
+}
+
+// Cost per combination of the generic and specialized lexicographic walks
+// and the revolving-door walk on instance 1 of seed with the given parameters,
+// then the speedup of optimal_brute_force_parallel at 1, 2, 4, ... up to
+// max_threads threads (<= 0: every core), each checked against the serial walk.
+void benchmark_enumeration(int L, int C, int T, int max_students, int max_duration, uint64_t seed, int max_threads) {
+    auto durations = generate_random_instance(L, max_students, max_duration, seed, 1);
+    Instance inst = build_instance(durations, T);
+    long long combinations = binomial(collect_events(inst).size(), C);
+
+    cout << "L=" << L << " C=" << C << " T=" << T
+         << " N=" << collect_events(inst).size() << " combinations=" << combinations << "\n";
+    const pair<const char*, vector<int> (*)(const Instance&, int)> walks[] = {
+        { "Lexicographic:  ", optimal_brute_force_generic },
+        { "Specialized:    ", optimal_brute_force_specialized },
+        { "Revolving door: ", optimal_brute_force_revolving_door },
+    };
+    for (const auto& walk : walks) {
+        auto start = high_resolution_clock::now();
+        auto times = walk.second(inst, C);
+        auto end = high_resolution_clock::now();
+        double ns = duration_cast<nanoseconds>(end - start).count();
+        cout << walk.first << ns / max(1LL, combinations) << " ns/combination, idle "
+             << (times.empty() ? -1 : calculate_total_unoccupied_time(inst, times)) << "\n";
+    }
+
+    if (max_threads <= 0) max_threads = max(1u, thread::hardware_concurrency());
+    vector<int> serial = optimal_brute_force_generic(inst, C);
+    double single_ns = 0;
+    for (int threads = 1;; threads = min(threads * 2, max_threads)) {
+        auto start = high_resolution_clock::now();
+        auto times = optimal_brute_force_parallel(inst, C, threads);
+        auto end = high_resolution_clock::now();
+        double ns = duration_cast<nanoseconds>(end - start).count();
+        if (threads == 1) single_ns = ns;
+        cout << "Parallel x" << threads << ": " << ns / max(1LL, combinations) << " ns/combination, speedup "
+             << single_ns / max(1.0, ns) << (times == serial ? "" : ", DIFFERS from the serial walk") << "\n";
+        if (threads == max_threads) break;
+    }
+}
+
+//--------------------------solution cache-------------------------
+// Canonical fingerprint of an instance for a given C. Each lab is reduced to
+// what the optimum depends on: its finish times <= T (every one is a candidate
+// event), followed by T + 1 if one of its first C students finishes past the
+// horizon (which makes the instance infeasible whatever the exact time). Labs
+// are then sorted, so instances that differ only in lab order share a key.
+// Layout: C, T, then per lab its length and values.
+struct CacheKey {
+    uint64_t hash = 0;
+    vector<int> words;
+
+    bool operator==(const CacheKey& o) const { return hash == o.hash && words == o.words; }
+};
+
+uint64_t hash_key_words(const vector<int>& words) {
+    uint64_t h = CounterRng::mix(words.size());
+    for (int w : words) h = CounterRng::mix(h ^ (uint32_t)w);
+    return h;
+}
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey& k) const { return k.hash; }
+};
+
+CacheKey canonical_key(const Instance& inst, int C) {
+    vector<int> start(inst.L), length(inst.L);
+    for (int l = 0; l < inst.L; ++l) {
+        start[l] = inst.offsets[l];
+        int n = 0;
+        while (n < inst.offsets[l + 1] - inst.offsets[l] && inst.finish[start[l] + n] <= inst.T) ++n;
+        // The stored finish time right after the in-horizon ones is past T
+        length[l] = n + (min(inst.students[l], C) > n);
+    }
+    auto value = [&](int l, int k) { return min(inst.finish[start[l] + k], inst.T + 1); };
+
+    vector<int> order(inst.L);
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&](int a, int b) {
+        for (int k = 0; k < length[a] && k < length[b]; ++k)
+            if (value(a, k) != value(b, k)) return value(a, k) < value(b, k);
+        return length[a] < length[b];
+    });
+
+    CacheKey key;
+    key.words.push_back(C);
+    key.words.push_back(inst.T);
+    for (int l : order) {
+        key.words.push_back(length[l]);
+        for (int k = 0; k < length[l]; ++k) key.words.push_back(value(l, k));
+    }
+    key.hash = hash_key_words(key.words);
+    return key;
+}
+
+struct CachedSolution {
+    vector<int> times;          // Empty when no feasible schedule exists
+    int idle = 0;
+};
+
+// Concurrent map from canonical keys to optimal schedules. Keys are spread
+// over independently locked shards by hash, and lookups only take a shared
+// lock, so concurrent solvers rarely contend.
+//
+// On disk (native byte order): "LABCACHE", uint32 version, uint64 count, then
+// per entry uint32 key length, int32 key words, uint32 schedule length,
+// int32 times, int32 idle. The hash is recomputed on load.
+class SolutionCache {
+public:
+    bool lookup(const CacheKey& key, CachedSolution& out) {
+        const Shard& s = shard(key);
+        shared_lock<shared_mutex> lock(s.m);
+        auto it = s.map.find(key);
+        if (it == s.map.end()) {
+            misses_.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        out = it->second;
+        hits_.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    void insert(const CacheKey& key, const CachedSolution& solution) {
+        Shard& s = shard(key);
+        unique_lock<shared_mutex> lock(s.m);
+        s.map.emplace(key, solution);
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const Shard& s : shards_) {
+            shared_lock<shared_mutex> lock(s.m);
+            n += s.map.size();
+        }
+        return n;
+    }
+
+    long long hits() const { return hits_.load(); }
+    long long misses() const { return misses_.load(); }
+
+    // Adds the entries of a cache file. A missing file is an empty cache.
+    bool load(const string& path, string& error) {
+        ifstream in(path, ios::binary);
+        if (!in) return true;
+        char magic[8];
+        uint32_t version = 0;
+        uint64_t count = 0;
+        in.read(magic, 8);
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!in || memcmp(magic, CACHE_FILE_MAGIC, 8) != 0 || version != CACHE_FILE_VERSION) {
+            error = path + ": not a version " + to_string(CACHE_FILE_VERSION) + " cache file";
+            return false;
+        }
+        auto read_words = [&](vector<int>& words) {
+            uint32_t n = 0;
+            in.read(reinterpret_cast<char*>(&n), sizeof(n));
+            if (!in || n > (1u << 28)) return false;
+            words.resize(n);
+            in.read(reinterpret_cast<char*>(words.data()), n * sizeof(int32_t));
+            return (bool)in;
+        };
+        for (uint64_t i = 0; i < count; ++i) {
+            CacheKey key;
+            CachedSolution solution;
+            if (!read_words(key.words) || !read_words(solution.times) ||
+                !in.read(reinterpret_cast<char*>(&solution.idle), sizeof(int32_t))) {
+                error = path + ": truncated at entry " + to_string(i);
+                return false;
+            }
+            key.hash = hash_key_words(key.words);
+            insert(key, solution);
+        }
+        return true;
+    }
+
+    // Writes every entry to a temporary file and renames it over path, so a
+    // crash never leaves a torn cache behind.
+    bool save(const string& path, string& error) const {
+        string temporary = path + ".tmp";
+        {
+            ofstream out(temporary, ios::binary);
+            if (!out) { error = "cannot write " + temporary; return false; }
+            uint64_t count = size();
+            out.write(CACHE_FILE_MAGIC, 8);
+            out.write(reinterpret_cast<const char*>(&CACHE_FILE_VERSION), sizeof(CACHE_FILE_VERSION));
+            out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+            auto write_words = [&](const vector<int>& words) {
+                uint32_t n = words.size();
+                out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+                out.write(reinterpret_cast<const char*>(words.data()), n * sizeof(int32_t));
+            };
+            for (const Shard& s : shards_) {
+                shared_lock<shared_mutex> lock(s.m);
+                for (const auto& entry : s.map) {
+                    write_words(entry.first.words);
+                    write_words(entry.second.times);
+                    out.write(reinterpret_cast<const char*>(&entry.second.idle), sizeof(int32_t));
+                }
+            }
+            if (!out) { error = "cannot write " + temporary; return false; }
+        }
+        if (rename(temporary.c_str(), path.c_str()) != 0) {
+            error = "cannot rename " + temporary + " to " + path;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int SHARDS = 64;
+    static constexpr char CACHE_FILE_MAGIC[9] = "LABCACHE";
+    static constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+    struct alignas(64) Shard {
+        mutable shared_mutex m;
+        unordered_map<CacheKey, CachedSolution, CacheKeyHash> map;
+    };
+
+    Shard& shard(const CacheKey& key) { return shards_[key.hash >> 58]; }
+    const Shard& shard(const CacheKey& key) const { return shards_[key.hash >> 58]; }
+
+    Shard shards_[SHARDS];
+    atomic<long long> hits_{0};
+    atomic<long long> misses_{0};
+};
+
+// Everything main reports about one instance.
+struct InstanceResult {
+    int instance_id = 0;
+    int N = 0;                      // Distinct events within the horizon
+    long long combinations = 0;     // C(N, C), the brute-force search space
+    vector<int> heuristic_times;
+    vector<int> optimal_times;      // Empty when no feasible schedule exists
+    int heuristic_idle = 0;
+    int optimal_idle = 0;
+    bool heuristic_feasible = false; // Heuristic times form a feasible schedule
+    bool brute_force_agrees = true;
+    long long heuristic_us = 0;
+    long long dp_us = -1;           // -1 when the DP was not run (cache hit)
+    long long brute_force_us = -1;  // -1 when the brute force was not run
+    long long cache_us = 0;         // Key and lookup time when a cache is used
+    bool cache_hit = false;         // Optimum taken from the solution cache
+#if SCHEDULER_INSTRUMENT
+    string metrics_json;            // Solver counters of this instance
+#endif
+};
+
+// Largest C(N, C) solve_instance still cross-checks with the brute force.
+// Beyond it the brute force is skipped: it is exponential in C, while the DP
+// it would confirm takes microseconds.
+const long long BRUTE_FORCE_CHECK_LIMIT = 100000;
+
+// Whether times is a feasible schedule of C inspections: chronological, within
+// the horizon, and each inspection after its index's required finish time.
+// The heuristic ignores both constraints, so its idle can undercut the optimum.
+bool schedule_feasible(const Instance& inst, const vector<int>& times, int C) {
+    if ((int)times.size() != C) return false;
+    IndexBounds bounds = compute_index_bounds(inst, C);
+    for (int i = 0; i < C; ++i) {
+        if (times[i] < bounds.required[i] || times[i] > inst.T || (i > 0 && times[i] <= times[i - 1]))
+            return false;
+    }
+    return true;
+}
+
+// Runs the heuristic, the exact DP and the timed brute force on one instance;
+// the brute force only while C(N, C) <= BRUTE_FORCE_CHECK_LIMIT. With a
+// cache, a repeated instance takes its optimum from the cache instead of the
+// DP and brute force, and fresh optima are added to it.
+InstanceResult solve_instance(int instance_id, const Instance& inst, int C, SolutionCache* cache = nullptr) {
+    InstanceResult r;
+    r.instance_id = instance_id;
+#if SCHEDULER_INSTRUMENT
+    solver_counters.reset();
+#endif
+
+    // Heuristic solution
+    {
+        INSTRUMENT_PHASE("heuristic");
+        auto start_heuristic = high_resolution_clock::now();
+        r.heuristic_times = schedule_inspections(inst, C);
+        r.heuristic_idle = calculate_total_unoccupied_time(inst, r.heuristic_times);
+        auto end_heuristic = high_resolution_clock::now();
+        r.heuristic_us = duration_cast<microseconds>(end_heuristic - start_heuristic).count();
+    }
+    r.heuristic_feasible = schedule_feasible(inst, r.heuristic_times, C);
+
+    // Brute-force solution (event collection)
+    {
+        INSTRUMENT_PHASE("events");
+        r.N = collect_events(inst).size();
+        r.combinations = binomial(r.N, C);
+        INSTRUMENT_COUNT(events, r.N);
+    }
+
+    CacheKey key;
+    if (cache) {
+        INSTRUMENT_PHASE("cache");
+        auto start_lookup = high_resolution_clock::now();
+        key = canonical_key(inst, C);
+        CachedSolution cached;
+        r.cache_hit = cache->lookup(key, cached);
+        if (r.cache_hit) {
+            r.optimal_times = cached.times;
+            r.optimal_idle = cached.idle;
+        }
+        r.cache_us = duration_cast<microseconds>(high_resolution_clock::now() - start_lookup).count();
+    }
+
+    if (!r.cache_hit) {
+        // Exact solution (event-based DP)
+        {
+            INSTRUMENT_PHASE("dp");
+            auto start_dp = high_resolution_clock::now();
+            r.optimal_times = optimal_dp(inst, C);
+            auto end_dp = high_resolution_clock::now();
+            r.dp_us = duration_cast<microseconds>(end_dp - start_dp).count();
+        }
+
+        // Time brute-force (kept for the runtime study; must agree with the DP)
+        if (r.combinations <= BRUTE_FORCE_CHECK_LIMIT) {
+            INSTRUMENT_PHASE("brute_force");
+            auto start_opt = high_resolution_clock::now();
+            auto brute_times = optimal_brute_force(inst, C);
+            auto end_opt = high_resolution_clock::now();
+            r.brute_force_us = duration_cast<microseconds>(end_opt - start_opt).count();
+            r.brute_force_agrees = (brute_times == r.optimal_times);
+        }
+
+        if (!r.optimal_times.empty())
+            r.optimal_idle = calculate_total_unoccupied_time(inst, r.optimal_times);
+        if (cache) {
+            CachedSolution fresh;
+            fresh.times = r.optimal_times;
+            fresh.idle = r.optimal_idle;
+            cache->insert(key, fresh);
+        }
+    }
+#if SCHEDULER_INSTRUMENT
+    r.metrics_json = solver_counters_json(instance_id, C);
+#endif
+    return r;
+}
+
+const char* RESULT_ROW_HEADER =
+    "Instance,N,C,Combinations,HeuristicIdle,OptimalIdle,Heuristic(us),DP(us),BruteForce(us)\n";
+
+//--------------------------online rescheduling-------------------------
+// Fenwick (binary indexed) tree: point update, prefix sum and k-th search, all
+// O(log n).
+class FenwickTree {
+public:
+    explicit FenwickTree(int n = 0) : tree_(n + 1, 0) {}
+
+    int size() const { return tree_.size() - 1; }
+
+    void add(int i, long long delta) {
+        for (++i; i < (int)tree_.size(); i += i & -i) tree_[i] += delta;
+    }
+
+    // Sum of positions [0, i)
+    long long prefix(int i) const {
+        long long s = 0;
+        for (; i > 0; i -= i & -i) s += tree_[i];
+        return s;
+    }
+
+    // Smallest position p with prefix(p + 1) >= k, for non-negative values
+    int find(long long k) const {
+        int pos = 0;
+        int step = 1;
+        while (step * 2 < (int)tree_.size()) step *= 2;
+        for (; step > 0; step /= 2) {
+            if (pos + step < (int)tree_.size() && tree_[pos + step] < k) {
+                pos += step;
+                k -= tree_[pos];
+            }
+        }
+        return pos;
+    }
+
+private:
+    vector<long long> tree_;
+};
+
+// Keeps the optimal schedule of a changing instance up to date. Each lab is a
+// queue of slots in two Fenwick trees (active flags and durations), so a
+// finish time is a prefix query. An ordered multiset holds the events within
+// the horizon. Per inspection index we keep the multiset of finish times,
+// which gives the requirement, the participating labs and their sum.
+//
+// Every inspection's idle grows with its time, so the optimum takes, index by
+// index, the earliest event that is at or after the requirement and later
+// than the previous inspection. An update to student k of a lab changes that
+// lab's finish times from k on, and with them possibly every requirement from
+// index k - 1 up, so the indices from there (or from the first chosen time
+// at or after a changed event, if earlier) are re-decided, each by one
+// O(log N) successor query. An update therefore costs O(m log n + r log N)
+// for the m finish times of that lab after student k within the horizon and
+// the r <= C re-decided indices: O(C log N) when an early student changes,
+// not polylogarithmic, but without rebuilding anything. Removed students'
+// slots are compacted away once they outnumber the active ones.
+class OnlineScheduler {
+public:
+    OnlineScheduler(const vector<vector<int>>& durations, int C, int T)
+        : C_(C), T_(T), by_index_(C), count_(C, 0), sum_(C, 0) {
+        for (const auto& lab : durations) {
+            labs_.emplace_back();
+            OnlineLab& ol = labs_.back();
+            ol.slots.assign(lab.begin(), lab.end());
+            ol.active.assign(lab.size(), 1);
+            rebuild(ol, max<int>(4, lab.size() * 2));
+            ol.students = lab.size();
+            apply_finishes(labs_.size() - 1, 1, +1);
+        }
+        repair(0);
+    }
+
+    int labs() const { return labs_.size(); }
+    int students(int lab) const { return labs_[lab].students; }
+
+    // Optimal inspection times; empty when no feasible schedule exists
+    const vector<int>& schedule() const { return schedule_; }
+
+    long long idle() const {
+        long long total = 0;
+        for (int i = 0; i < (int)schedule_.size(); ++i)
+            total += count_[i] * (long long)schedule_[i] - sum_[i];
+        return total;
+    }
+
+    // Indices re-decided by the last update
+    int last_repaired() const { return last_repaired_; }
+
+    // A new student joins the end of the lab's queue.
+    void add_student(int lab, int duration) {
+        OnlineLab& ol = labs_[lab];
+        if ((int)ol.slots.size() == ol.durations.size()) rebuild(ol, max(4, (ol.students + 1) * 2));
+        int k = ol.students + 1;
+        int slot = ol.slots.size();
+        ol.slots.push_back(duration);
+        ol.active.push_back(1);
+        ol.counts.add(slot, 1);
+        ol.durations.add(slot, duration);
+        ++ol.students;
+        apply_finishes(lab, k, +1);
+        repair_after(k);
+    }
+
+    // The k-th student (1-based) of the lab leaves the queue. False if there
+    // is no such student.
+    bool remove_student(int lab, int k) {
+        OnlineLab& ol = labs_[lab];
+        if (k < 1 || k > ol.students) return false;
+        apply_finishes(lab, k, -1);
+        int slot = ol.counts.find(k);
+        ol.counts.add(slot, -1);
+        ol.durations.add(slot, -ol.slots[slot]);
+        ol.active[slot] = 0;
+        --ol.students;
+        if ((int)ol.slots.size() > 2 * ol.students + 4) rebuild(ol, max(4, ol.students * 2));
+        apply_finishes(lab, k, +1);
+        repair_after(k);
+        return true;
+    }
+
+    // The k-th student (1-based) of the lab now takes `duration`, e.g. after
+    // an overrun. False if there is no such student.
+    bool change_duration(int lab, int k, int duration) {
+        OnlineLab& ol = labs_[lab];
+        if (k < 1 || k > ol.students) return false;
+        apply_finishes(lab, k, -1);
+        int slot = ol.counts.find(k);
+        ol.durations.add(slot, duration - ol.slots[slot]);
+        ol.slots[slot] = duration;
+        apply_finishes(lab, k, +1);
+        repair_after(k);
+        return true;
+    }
+
+private:
+    struct OnlineLab {
+        vector<int> slots;          // Duration per slot, in queue order
+        vector<char> active;        // Removed students leave inactive slots
+        FenwickTree counts;         // 1 per active slot
+        FenwickTree durations;      // Duration per active slot
+        int students = 0;
+    };
+
+    // Drops the inactive slots and re-creates the trees with room for
+    // `capacity` slots (at least the number of active students)
+    static void rebuild(OnlineLab& ol, int capacity) {
+        int kept = 0;
+        for (int s = 0; s < (int)ol.slots.size(); ++s) {
+            if (ol.active[s]) ol.slots[kept++] = ol.slots[s];
+        }
+        ol.slots.resize(kept);
+        ol.active.assign(kept, 1);
+        ol.counts = FenwickTree(capacity);
+        ol.durations = FenwickTree(capacity);
+        for (int s = 0; s < kept; ++s) {
+            ol.counts.add(s, 1);
+            ol.durations.add(s, ol.slots[s]);
+        }
+    }
+
+    // Adds (sign +1) or removes (sign -1) the lab's finish times from student
+    // k on: events within the horizon and entries for indices up to C.
+    void apply_finishes(int lab, int k, int sign) {
+        OnlineLab& ol = labs_[lab];
+        if (k > ol.students) return;
+        int slot = ol.counts.find(k);
+        long long finish = ol.durations.prefix(slot);
+        for (int j = k; slot < (int)ol.slots.size(); ++slot) {
+            if (!ol.active[slot]) continue;
+            finish += ol.slots[slot];
+            if (j > C_ && finish > T_) break;
+            int f = (int)min<long long>(finish, numeric_limits<int>::max());
+            if (f <= T_) {
+                if (sign > 0) events_.insert(f);
+                else events_.erase(events_.find(f));
+                changed_from_ = min(changed_from_, f);
+            }
+            if (j <= C_) {
+                if (sign > 0) by_index_[j - 1].insert(f);
+                else by_index_[j - 1].erase(by_index_[j - 1].find(f));
+                count_[j - 1] += sign;
+                sum_[j - 1] += sign * (long long)f;
+            }
+            ++j;
+        }
+    }
+
+    // After an update at student k: indices from k - 1 on have new
+    // requirements, and earlier ones only move if an event at or before their
+    // chosen time changed.
+    void repair_after(int k) {
+        int first = min(k - 1, C_);
+        if (!schedule_.empty()) {
+            for (int i = 0; i < first; ++i) {
+                if (schedule_[i] >= changed_from_) { first = i; break; }
+            }
+        } else {
+            first = 0;
+        }
+        repair(first);
+    }
+
+    void repair(int first) {
+        changed_from_ = numeric_limits<int>::max();
+        if (schedule_.size() != (size_t)C_) first = 0;
+        vector<int> chosen(schedule_.begin(), schedule_.begin() + min<size_t>(first, schedule_.size()));
+        last_repaired_ = C_ - first;
+        for (int i = first; i < C_; ++i) {
+            int required = by_index_[i].empty() ? 0 : *by_index_[i].rbegin();
+            int earliest = chosen.empty() ? required : max(required, chosen.back() + 1);
+            auto it = events_.lower_bound(earliest);
+            if (it == events_.end()) {
+                schedule_.clear();
+                return;
+            }
+            chosen.push_back(*it);
+        }
+        schedule_ = chosen;
+    }
+
+    int C_;
+    int T_;
+    vector<OnlineLab> labs_;
+    multiset<int> events_;
+    vector<multiset<int>> by_index_;    // Finish times of each inspection index
+    vector<int> count_;
+    vector<long long> sum_;
+    vector<int> schedule_;
+    int changed_from_ = numeric_limits<int>::max();
+    int last_repaired_ = 0;
+};
+
+// Replays random updates (joins, departures and duration changes) on
+// instance 1 of seed and checks the online schedule after every one against
+// optimal_dp solved from scratch on the same durations.
+int run_online(int L, int C, int T, int max_students, int max_duration, int updates, uint64_t seed) {
+    vector<vector<int>> durations = generate_random_instance(L, max_students, max_duration, seed, 1);
+    OnlineScheduler online(durations, C, T);
+    CounterRng rng(seed, 0, 0); // instance 0 is never generated, so its streams are free
+
+    long long mismatches = 0, repaired = 0;
+    double online_us = 0, full_us = 0;
+    for (int u = 0; u < updates; ++u) {
+        int lab = rng.uniform(0, L - 1);
+        int n = durations[lab].size();
+        int kind = n == 0 ? 0 : rng.uniform(0, 2);
+        auto start = high_resolution_clock::now();
+        if (kind == 0) {
+            int d = rng.uniform(1, max_duration);
+            durations[lab].push_back(d);
+            online.add_student(lab, d);
+        } else if (kind == 1) {
+            int k = rng.uniform(1, n);
+            durations[lab].erase(durations[lab].begin() + (k - 1));
+            online.remove_student(lab, k);
+        } else {
+            int k = rng.uniform(1, n), d = rng.uniform(1, max_duration);
+            durations[lab][k - 1] = d;
+            online.change_duration(lab, k, d);
+        }
+        auto end = high_resolution_clock::now();
+        online_us += duration<double, micro>(end - start).count();
+        repaired += online.last_repaired();
+
+        start = high_resolution_clock::now();
+        Instance inst = build_instance(durations, T);
+        vector<int> reference = optimal_dp(inst, C);
+        end = high_resolution_clock::now();
+        full_us += duration<double, micro>(end - start).count();
+        if (online.schedule() != reference ||
+            (!reference.empty() && online.idle() != calculate_total_unoccupied_time(inst, reference)))
+            ++mismatches;
+    }
+
+    cout << "L=" << L << " C=" << C << " T=" << T << ": " << updates << " updates, " << mismatches
+         << " mismatches against optimal_dp\n";
+    if (updates > 0)
+        cout << "Mean indices re-decided: " << (double)repaired / updates << ", online "
+             << online_us / updates << " us/update, full DP " << full_us / updates << " us/update\n";
+    return mismatches == 0 ? 0 : 1;
+}
+
+//--------------------------result sink-------------------------
+// Fixed-capacity block of results stored column by column. Chosen times vary
+// in length per row, so they sit in flat columns indexed by per-row offsets.
+struct ResultBlock {
+    static const int CAPACITY = 1024;
+
+    int rows = 0;
+    vector<int32_t> instance_id, N, C;
+    vector<int64_t> combinations;
+    vector<int32_t> heuristic_idle, optimal_idle;       // optimal_idle is -1 when infeasible
+    vector<uint8_t> brute_force_agrees;
+    vector<int64_t> heuristic_us, dp_us, brute_force_us;  // -1 when the solver was not run
+    vector<uint32_t> heuristic_offsets, optimal_offsets; // rows + 1 entries each
+    vector<int32_t> heuristic_times, optimal_times;
+#if SCHEDULER_INSTRUMENT
+    vector<uint32_t> metrics_offsets;                    // rows + 1 entries
+    vector<char> metrics_text;                           // One JSON object per row
+#endif
+
+    ResultBlock() {
+        for (auto* col : { &instance_id, &N, &C, &heuristic_idle, &optimal_idle }) col->reserve(CAPACITY);
+        for (auto* col : { &combinations, &heuristic_us, &dp_us, &brute_force_us }) col->reserve(CAPACITY);
+        brute_force_agrees.reserve(CAPACITY);
+        clear();
+    }
+
+    bool full() const { return rows == CAPACITY; }
+
+    void clear() {
+        rows = 0;
+        for (auto* col : { &instance_id, &N, &C, &heuristic_idle, &optimal_idle, &heuristic_times, &optimal_times })
+            col->clear();
+        for (auto* col : { &combinations, &heuristic_us, &dp_us, &brute_force_us }) col->clear();
+        brute_force_agrees.clear();
+        heuristic_offsets.assign(1, 0);
+        optimal_offsets.assign(1, 0);
+#if SCHEDULER_INSTRUMENT
+        metrics_offsets.assign(1, 0);
+        metrics_text.clear();
+#endif
+    }
+
+    void append(const InstanceResult& r, int inspections) {
+        instance_id.push_back(r.instance_id);
+        N.push_back(r.N);
+        C.push_back(inspections);
+        combinations.push_back(r.combinations);
+        heuristic_idle.push_back(r.heuristic_idle);
+        optimal_idle.push_back(r.optimal_times.empty() ? -1 : r.optimal_idle);
+        brute_force_agrees.push_back(r.brute_force_agrees);
+        heuristic_us.push_back(r.heuristic_us);
+        dp_us.push_back(r.dp_us);
+        brute_force_us.push_back(r.brute_force_us);
+        heuristic_times.insert(heuristic_times.end(), r.heuristic_times.begin(), r.heuristic_times.end());
+        optimal_times.insert(optimal_times.end(), r.optimal_times.begin(), r.optimal_times.end());
+        heuristic_offsets.push_back(heuristic_times.size());
+        optimal_offsets.push_back(optimal_times.size());
+#if SCHEDULER_INSTRUMENT
+        metrics_text.insert(metrics_text.end(), r.metrics_json.begin(), r.metrics_json.end());
+        metrics_offsets.push_back(metrics_text.size());
+#endif
+        ++rows;
+    }
+};
+
+// Consumer of result blocks; runs on the sink's writer thread only.
+class ResultExporter {
+public:
+    virtual ~ResultExporter() = default;
+    virtual void write(const ResultBlock& block) = 0;
+    virtual void finish() {}
+};
+
+// Binary columnar file: per block a uint32 row count followed by each column
+// as a raw array, in the order declared in ResultBlock.
+class ColumnFileExporter : public ResultExporter {
+public:
+    explicit ColumnFileExporter(const string& path) : out_(path, ios::binary) {}
+
+    void write(const ResultBlock& b) override {
+        uint32_t rows = b.rows;
+        out_.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+        column(b.instance_id); column(b.N); column(b.C); column(b.combinations);
+        column(b.heuristic_idle); column(b.optimal_idle); column(b.brute_force_agrees);
+        column(b.heuristic_us); column(b.dp_us); column(b.brute_force_us);
+        column(b.heuristic_offsets); column(b.optimal_offsets);
+        column(b.heuristic_times); column(b.optimal_times);
+    }
+
+private:
+    template <class T>
+    void column(const vector<T>& values) {
+        out_.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    ofstream out_;
+};
+
+// The runtime CSVs main has always produced (brute_force_runtime.csv and
+// approx_runtime.csv). Instances whose brute force did not run, being over the
+// check limit or answered from the cache, get no brute-force row.
+class RuntimeCsvExporter : public ResultExporter {
+public:
+    RuntimeCsvExporter(const string& brute_force_path, const string& heuristic_path)
+        : csv_(brute_force_path), heuristic_csv_(heuristic_path) {
+        csv_ << "Instance,N,C,Combinations,Runtime(us)\n";
+        heuristic_csv_ << "Instance,C,Runtime(us)\n";
+    }
+
+    void write(const ResultBlock& b) override {
+        for (int i = 0; i < b.rows; ++i) {
+            heuristic_csv_ << b.instance_id[i] << "," << b.C[i] << "," << b.heuristic_us[i] << "\n";
+            if (b.optimal_idle[i] >= 0 && b.brute_force_us[i] >= 0)
+                csv_ << b.instance_id[i] << "," << b.N[i] << "," << b.C[i] << "," << b.combinations[i]
+                     << "," << b.brute_force_us[i] << "\n";
+        }
+    }
+
+private:
+    ofstream csv_;
+    ofstream heuristic_csv_;
+};
+
+// Human-readable per-instance report of the default run.
+class ReportExporter : public ResultExporter {
+public:
+    explicit ReportExporter(ostream& out) : out_(out) {}
+
+    void write(const ResultBlock& b) override {
+        for (int i = 0; i < b.rows; ++i) {
+            if (b.optimal_idle[i] < 0) {
+                out_ << "\nInstance " << b.instance_id[i] << ": No valid optimal schedule found.\n";
+                continue;
+            }
+            int heuristic_idle = b.heuristic_idle[i], optimal_idle = b.optimal_idle[i];
+            out_ << "\nInstance " << b.instance_id[i] << "\n";
+            out_ << "Optimal solution:\nTimes: ";
+            for (uint32_t k = b.optimal_offsets[i]; k < b.optimal_offsets[i + 1]; ++k) out_ << b.optimal_times[k] << " ";
+            out_ << "\nIdle time: " << optimal_idle << "\n";
+            if (b.dp_us[i] < 0) out_ << "DP runtime (us): cached\n";
+            else out_ << "DP runtime (us): " << b.dp_us[i] << "\n";
+            if (!b.brute_force_agrees[i])
+                out_ << "Warning: brute force disagrees with the DP\n";
+
+            out_ << "\nComparison:\n";
+            out_ << "Heuristic idle: " << heuristic_idle << "\n";
+            out_ << "Optimal idle: " << optimal_idle << "\n";
+            out_ << "Difference: " << (heuristic_idle - optimal_idle)
+                 << " (" << 100.0 * (heuristic_idle - optimal_idle) / optimal_idle << "% worse)\n";
+        }
+    }
+
+    void finish() override { out_.flush(); }
+
+private:
+    ostream& out_;
+};
+
+// Compact CSV rows (RESULT_ROW_HEADER) for the batch and file-driven modes.
+class RowExporter : public ResultExporter {
+public:
+    explicit RowExporter(ostream& out) : out_(out) { out_ << RESULT_ROW_HEADER; }
+
+    void write(const ResultBlock& b) override {
+        for (int i = 0; i < b.rows; ++i) {
+            out_ << b.instance_id[i] << "," << b.N[i] << "," << b.C[i] << "," << b.combinations[i] << ","
+                 << b.heuristic_idle[i] << ",";
+            if (b.optimal_idle[i] < 0) out_ << "none";
+            else out_ << b.optimal_idle[i];
+            out_ << "," << b.heuristic_us[i];
+            for (int64_t us : { b.dp_us[i], b.brute_force_us[i] }) {
+                if (us < 0) out_ << ",none";
+                else out_ << "," << us;
+            }
+            out_ << "\n";
+        }
+    }
+
+    void finish() override { out_.flush(); }
+
+private:
+    ostream& out_;
+};
+
+#if SCHEDULER_INSTRUMENT
+// Solver counters as JSON lines, one object per instance.
+class MetricsJsonExporter : public ResultExporter {
+public:
+    explicit MetricsJsonExporter(const string& path) : out_(path) {}
+
+    void write(const ResultBlock& b) override {
+        for (int i = 0; i < b.rows; ++i) {
+            out_.write(b.metrics_text.data() + b.metrics_offsets[i], b.metrics_offsets[i + 1] - b.metrics_offsets[i]);
+            out_ << "\n";
+        }
+    }
+
+    void finish() override { out_.flush(); }
+
+private:
+    ofstream out_;
+};
+#endif
+
+// Collects results into columnar blocks and hands full blocks to a background
+// writer thread that runs the exporters. Submitting only appends to the open
+// block under a short lock; it never waits for I/O. Rows are exported in
+// submission order.
+class ResultSink {
+public:
+    ResultSink() : writer_([this] { write_loop(); }) {}
+    ~ResultSink() { close(); }
+
+    // Exporters must be added before the first submit.
+    void add_exporter(unique_ptr<ResultExporter> exporter) { exporters_.push_back(move(exporter)); }
+
+    void submit(const InstanceResult& r, int C) {
+        lock_guard<mutex> lock(mutex_);
+        if (!open_) open_ = take_block();
+        open_->append(r, C);
+        if (open_->full()) {
+            ready_.push_back(move(open_));
+            ready_cv_.notify_one();
+        }
+    }
+
+    // Hands over the partly filled block, e.g. at the end of a batch window.
+    void flush() {
+        lock_guard<mutex> lock(mutex_);
+        if (open_ && open_->rows > 0) {
+            ready_.push_back(move(open_));
+            ready_cv_.notify_one();
+        }
+    }
+
+    // Exports everything submitted so far and stops the writer.
+    void close() {
+        if (!writer_.joinable()) return;
+        flush();
+        {
+            lock_guard<mutex> lock(mutex_);
+            closing_ = true;
+        }
+        ready_cv_.notify_one();
+        writer_.join();
+        for (auto& e : exporters_) e->finish();
+    }
+
+private:
+    unique_ptr<ResultBlock> take_block() {
+        if (free_.empty()) return unique_ptr<ResultBlock>(new ResultBlock());
+        unique_ptr<ResultBlock> b = move(free_.back());
+        free_.pop_back();
+        return b;
+    }
+
+    void write_loop() {
+        while (true) {
+            unique_ptr<ResultBlock> block;
+            {
+                unique_lock<mutex> lock(mutex_);
+                ready_cv_.wait(lock, [this] { return closing_ || !ready_.empty(); });
+                if (ready_.empty()) return;
+                block = move(ready_.front());
+                ready_.pop_front();
+            }
+            for (auto& e : exporters_) e->write(*block);
+            block->clear();
+            lock_guard<mutex> lock(mutex_);
+            free_.push_back(move(block));
+        }
+    }
+
+    vector<unique_ptr<ResultExporter>> exporters_;
+    mutex mutex_;
+    condition_variable ready_cv_;
+    unique_ptr<ResultBlock> open_;
+    deque<unique_ptr<ResultBlock>> ready_;
+    vector<unique_ptr<ResultBlock>> free_;
+    bool closing_ = false;
+    thread writer_;
+};
+
+// Batch totals owned by one worker thread. Each worker only writes its own
+// cache-line-aligned slot, so no locks or atomics are needed until the merge.
+struct alignas(64) BatchAccumulator {
+    long long solved = 0;
+    long long infeasible = 0;
+    long long heuristic_idle = 0;
+    long long optimal_idle = 0;
+    double gap_percent_sum = 0;     // Over feasible heuristic schedules with a non-zero optimum
+    long long gap_count = 0;
+    long long heuristic_infeasible = 0; // Solved instances the heuristic schedules infeasibly
+    long long heuristic_us = 0;
+    long long dp_us = 0;
+    long long brute_force_us = 0;
+    long long brute_force_checked = 0;
+    long long cache_us = 0;
+    long long cache_hits = 0;
+
+    void add(const InstanceResult& r) {
+        heuristic_us += r.heuristic_us;
+        if (r.dp_us >= 0) dp_us += r.dp_us;
+        cache_us += r.cache_us;
+        cache_hits += r.cache_hit;
+        if (r.brute_force_us >= 0) {
+            brute_force_us += r.brute_force_us;
+            ++brute_force_checked;
+        }
+        if (r.optimal_times.empty()) {
+            ++infeasible;
+            return;
+        }
+        ++solved;
+        heuristic_idle += r.heuristic_idle;
+        optimal_idle += r.optimal_idle;
+        heuristic_infeasible += !r.heuristic_feasible;
+        if (r.heuristic_feasible && r.optimal_idle > 0) {
+            gap_percent_sum += 100.0 * (r.heuristic_idle - r.optimal_idle) / r.optimal_idle;
+            ++gap_count;
+        }
+    }
+
+    void merge(const BatchAccumulator& o) {
+        solved += o.solved;
+        infeasible += o.infeasible;
+        heuristic_idle += o.heuristic_idle;
+        optimal_idle += o.optimal_idle;
+        gap_percent_sum += o.gap_percent_sum;
+        gap_count += o.gap_count;
+        heuristic_infeasible += o.heuristic_infeasible;
+        heuristic_us += o.heuristic_us;
+        dp_us += o.dp_us;
+        brute_force_us += o.brute_force_us;
+        brute_force_checked += o.brute_force_checked;
+        cache_us += o.cache_us;
+        cache_hits += o.cache_hits;
+    }
+};
+
+void print_batch_totals(const BatchAccumulator& total) {
+    cout << "Solved: " << total.solved << ", no feasible schedule: " << total.infeasible << "\n";
+    cout << "Heuristic idle: " << total.heuristic_idle << ", optimal idle: " << total.optimal_idle << "\n";
+    if (total.gap_count > 0)
+        cout << "Mean heuristic gap: " << total.gap_percent_sum / total.gap_count << "% worse over "
+             << total.gap_count << " instances\n";
+    cout << "Heuristic schedule infeasible: " << total.heuristic_infeasible << " of " << total.solved << "\n";
+    cout << "Runtime (us): heuristic " << total.heuristic_us << ", DP " << total.dp_us
+         << ", brute force " << total.brute_force_us << " (" << total.brute_force_checked
+         << " instances cross-checked)\n";
+    if (total.cache_hits > 0 || total.cache_us > 0)
+        cout << "Cache: " << total.cache_hits << " hits, lookups " << total.cache_us << " us\n";
+}
+
+// Solves num_instances random instances on a thread pool. Instances are taken
+// in windows of a few per thread to keep memory bounded; inside a window the
+// most expensive ones (by C(N, C)) are started first, and the window's results
+// go to the sink in instance order once it completes.
+void run_batch(int num_instances, int num_threads, int L, int C, int T, uint64_t seed, ResultSink& sink,
+               SolutionCache* cache) {
+    if (num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+    const int window = num_threads * 64;
+    vector<BatchAccumulator> totals(num_threads);
+
+    for (int base = 1; base <= num_instances; base += window) {
+        int count = min(window, num_instances - base + 1);
+
+        // Runs body(k, worker) for k = 0..count-1 on the pool
+        auto parallel_for = [&](auto&& body) {
+            atomic<int> next{0};
+            auto worker = [&](int self) {
+                for (int k; (k = next.fetch_add(1)) < count;) body(k, self);
+            };
+            vector<thread> pool;
+            for (int w = 1; w < num_threads; ++w) pool.emplace_back(worker, w);
+            worker(0);
+            for (auto& th : pool) th.join();
+        };
+
+        vector<Instance> instances(count);
+        vector<long long> cost(count);
+        parallel_for([&](int i, int) {
+            instances[i] = build_instance(generate_instance(L, seed, base + i), T, C);
+            cost[i] = binomial(collect_events(instances[i]).size(), C);
+        });
+        vector<int> order(count);
+        iota(order.begin(), order.end(), 0);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return cost[a] > cost[b]; });
+
+        vector<InstanceResult> results(count);
+        parallel_for([&](int k, int self) {
+            int i = order[k];
+            results[i] = solve_instance(base + i, instances[i], C, cache);
+            totals[self].add(results[i]);
+        });
+
+        for (const auto& r : results) sink.submit(r, C);
+        sink.flush();
+    }
+    sink.close();
+
+    BatchAccumulator total;
+    for (const auto& t : totals) total.merge(t);
+    cout << "\nBatch of " << num_instances << " instances on " << num_threads << " threads\n";
+    print_batch_totals(total);
+}
+
+//--------------------------pipeline-------------------------
+// Bounded multi-producer multi-consumer queue without locks (Vyukov): every
+// cell carries a sequence number that tells producers and consumers whose turn
+// it is, so a push or pop is one CAS on its index plus the cell handoff.
+// push spins (then sleeps briefly) while the queue is full, which is the
+// backpressure that keeps a pipeline's memory flat.
+template <class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n *= 2;
+        mask_ = n - 1;
+        cells_.reset(new Cell[n]);
+        for (size_t i = 0; i < n; ++i) cells_[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    bool try_push(T& value) {
+        size_t pos = tail_.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            intptr_t diff = (intptr_t)cell.sequence.load(memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.value = move(value);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // full
+            } else {
+                pos = tail_.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_pop(T& value) {
+        size_t pos = head_.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[pos & mask_];
+            intptr_t diff = (intptr_t)cell.sequence.load(memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    value = move(cell.value);
+                    cell.sequence.store(pos + mask_ + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false; // empty
+            } else {
+                pos = head_.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    void push(T value) {
+        for (int spins = 0; !try_push(value); ++spins) backoff(spins);
+    }
+
+    // Blocks until an item arrives; false once the queue is closed and drained.
+    bool pop(T& value) {
+        for (int spins = 0; !try_pop(value); ++spins) {
+            if (closed_.load(memory_order_acquire)) return try_pop(value);
+            backoff(spins);
+        }
+        return true;
+    }
+
+    // No more pushes will follow.
+    void close() { closed_.store(true, memory_order_release); }
+
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    static void backoff(int spins) {
+        if (spins < 64) this_thread::yield();
+        else this_thread::sleep_for(microseconds(50));
+    }
+
+    unique_ptr<Cell[]> cells_;
+    size_t mask_ = 0;
+    alignas(64) atomic<size_t> tail_{0};
+    alignas(64) atomic<size_t> head_{0};
+    alignas(64) atomic<bool> closed_{false};
+};
+
+// Busy time of one pipeline stage, summed over its threads.
+struct alignas(64) StageClock {
+    atomic<long long> busy_ns{0};
+
+    template <class F>
+    void time(F&& work) {
+        auto start = steady_clock::now();
+        work();
+        busy_ns.fetch_add(duration_cast<nanoseconds>(steady_clock::now() - start).count(), memory_order_relaxed);
+    }
+};
+
+// Same instances and results as run_batch, but as four overlapping stages
+// joined by bounded queues: a generator, preprocessing (build_instance), a
+// solver pool and the sink stage on the calling thread, which restores
+// instance order before handing results to the sink. The generator runs at
+// most a fixed window ahead of the sink, so memory stays flat however many
+// instances run, and throughput is set by the slowest stage.
+void run_pipeline(int num_instances, int num_threads, int L, int C, int T, uint64_t seed, ResultSink& sink,
+                  SolutionCache* cache) {
+    if (num_threads <= 0) num_threads = max(1u, thread::hardware_concurrency());
+    const int num_preprocess = max(1, num_threads / 4);
+    const size_t capacity = 256;
+    // The generator stays at most this far ahead of the sink, which bounds the
+    // reorder buffer even while one slow instance holds back the rest
+    const int window = 4 * capacity + num_threads;
+    atomic<int> next_sunk(1);
+
+    struct Generated {
+        int id = 0;
+        vector<vector<int>> durations;
+    };
+    struct Built {
+        int id = 0;
+        Instance inst;
+    };
+    BoundedQueue<Generated> generated(capacity);
+    BoundedQueue<Built> built(capacity);
+    BoundedQueue<InstanceResult> solved(capacity);
+    StageClock source_clock, preprocess_clock, solve_clock, sink_clock;
+    vector<BatchAccumulator> totals(num_threads);
+
+    auto start = steady_clock::now();
+    vector<thread> stages;
+    stages.emplace_back([&] {
+        for (int id = 1; id <= num_instances; ++id) {
+            while (id - next_sunk.load(memory_order_acquire) >= window) this_thread::sleep_for(microseconds(50));
+            Generated g;
+            source_clock.time([&] {
+                g.id = id;
+                g.durations = generate_instance(L, seed, id);
+            });
+            generated.push(move(g));
+        }
+        generated.close();
+    });
+
+    atomic<int> preprocess_left(num_preprocess);
+    for (int p = 0; p < num_preprocess; ++p) {
+        stages.emplace_back([&] {
+            Generated g;
+            while (generated.pop(g)) {
+                Built b;
+                preprocess_clock.time([&] {
+                    b.id = g.id;
+                    b.inst = build_instance(g.durations, T, C);
+                });
+                built.push(move(b));
+            }
+            if (preprocess_left.fetch_sub(1) == 1) built.close();
+        });
+    }
+
+    atomic<int> solvers_left(num_threads);
+    for (int w = 0; w < num_threads; ++w) {
+        stages.emplace_back([&, w] {
+            Built b;
+            while (built.pop(b)) {
+                InstanceResult r;
+                solve_clock.time([&] { r = solve_instance(b.id, b.inst, C, cache); });
+                totals[w].add(r);
+                solved.push(move(r));
+            }
+            if (solvers_left.fetch_sub(1) == 1) solved.close();
+        });
+    }
+
+    // Sink stage: results arrive in completion order and leave in instance order
+    map<int, InstanceResult> reorder;
+    int next_id = 1;
+    InstanceResult r;
+    while (solved.pop(r)) {
+        sink_clock.time([&] {
+            int id = r.instance_id;
+            reorder.emplace(id, move(r));
+            for (auto it = reorder.begin(); it != reorder.end() && it->first == next_id; it = reorder.erase(it)) {
+                sink.submit(it->second, C);
+                ++next_id;
+            }
+            next_sunk.store(next_id, memory_order_release);
+        });
+    }
+    for (auto& th : stages) th.join();
+    sink.close();
+    double wall_s = duration<double>(steady_clock::now() - start).count();
+
+    BatchAccumulator total;
+    for (const auto& t : totals) total.merge(t);
+    cout << "\nPipeline of " << num_instances << " instances: " << num_preprocess << " preprocessing and "
+         << num_threads << " solver threads\n";
+    print_batch_totals(total);
+    auto busy = [](const StageClock& c) { return c.busy_ns.load() / 1e9; };
+    cout << "Stage busy time (s): generate " << busy(source_clock) << ", preprocess " << busy(preprocess_clock)
+         << ", solve " << busy(solve_clock) << ", sink " << busy(sink_clock) << "; wall " << wall_s << "\n";
+}
+
+// Cycle counter where the CPU exposes one cheaply (TSC on x86-64, the virtual
+// counter on AArch64); 0 elsewhere.
+uint64_t read_cycle_counter() {
+#if defined(SCHEDULER_X86_KERNELS)
+    return __rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return 0;
+#endif
+}
+
+// Summary of repeated timings of one phase.
+struct TimingStats {
+    int samples = 0;
+    double median_ns = 0;
+    double p90_ns = 0;
+    double p99_ns = 0;
+    double ci_low_ns = 0;       // 95% confidence interval of the median
+    double ci_high_ns = 0;
+    double median_cycles = 0;
+};
+
+// Order statistics of the samples. The median's 95% interval uses the
+// distribution-free ranks n/2 -+ 1.96 sqrt(n)/2.
+TimingStats summarize_timings(vector<double> ns, vector<double> cycles) {
+    TimingStats s;
+    s.samples = ns.size();
+    if (ns.empty()) return s;
+    sort(ns.begin(), ns.end());
+    sort(cycles.begin(), cycles.end());
+    int n = ns.size();
+    auto at = [&](double q) { return ns[min(n - 1, (int)(q * (n - 1) + 0.5))]; };
+    s.median_ns = at(0.5);
+    s.p90_ns = at(0.9);
+    s.p99_ns = at(0.99);
+    double half_width = 1.96 * sqrt((double)n) / 2;
+    s.ci_low_ns = ns[max(0, (int)floor(n / 2.0 - half_width))];
+    s.ci_high_ns = ns[min(n - 1, (int)ceil(n / 2.0 + half_width))];
+    s.median_cycles = cycles[n / 2];
+    return s;
+}
+
+// Times `phase` after `warmup` untimed calls. Calls shorter than
+// min_sample_ns (~1 µs by default) are batched so every sample sits well
+// above the clock's resolution.
+template <class Phase>
+TimingStats measure_phase(Phase&& phase, int warmup, int repetitions, long long min_sample_ns = 1000) {
+    for (int i = 0; i < warmup; ++i) phase();
+
+    int batch = 1;
+    while (batch < (1 << 20)) {
+        auto start = steady_clock::now();
+        for (int i = 0; i < batch; ++i) phase();
+        if (duration_cast<nanoseconds>(steady_clock::now() - start).count() >= min_sample_ns) break;
+        batch *= 2;
+    }
+
+    vector<double> ns, cycles;
+    for (int r = 0; r < repetitions; ++r) {
+        uint64_t c0 = read_cycle_counter();
+        auto start = steady_clock::now();
+        for (int i = 0; i < batch; ++i) phase();
+        auto end = steady_clock::now();
+        uint64_t c1 = read_cycle_counter();
+        ns.push_back((double)duration_cast<nanoseconds>(end - start).count() / batch);
+        cycles.push_back((double)(c1 - c0) / batch);
+    }
+    return summarize_timings(ns, cycles);
+}
+
+// Keeps benchmarked results observable so the calls are not optimized away.
+volatile long long benchmark_sink = 0;
+
+// Times event collection, the heuristic, brute force and the DP separately
+// over a grid of L, C, max_students and T. Brute force is skipped once C(N, C)
+// exceeds max_combinations. Prints one CSV row per configuration and phase.
+void run_benchmark(int repetitions, uint64_t seed, long long max_combinations) {
+    const int warmup = max(1, repetitions / 10);
+    const vector<int> lab_counts = { 3, 30, 300 };
+    const vector<int> inspection_counts = { 2, 4, 8 };
+    const vector<int> student_bounds = { 10, 40 };
+    const vector<int> horizons = { 24, 96 };
+
+    cout << "L,C,max_students,T,N,Phase,Samples,Median(ns),P90(ns),P99(ns),CI95Low(ns),CI95High(ns),MedianCycles\n";
+    for (int L : lab_counts)
+    for (int C : inspection_counts)
+    for (int max_students : student_bounds)
+    for (int T : horizons) {
+        Instance inst = build_instance(generate_random_instance(L, max_students, 24, seed, 1), T);
+        int N = collect_events(inst).size();
+
+        auto report = [&](const string& phase, const TimingStats& s) {
+            cout << L << "," << C << "," << max_students << "," << T << "," << N << "," << phase << ","
+                 << s.samples << "," << s.median_ns << "," << s.p90_ns << "," << s.p99_ns << ","
+                 << s.ci_low_ns << "," << s.ci_high_ns << "," << s.median_cycles << "\n";
+        };
+
+        report("events", measure_phase([&] { benchmark_sink += collect_events(inst).size(); }, warmup, repetitions));
+        report("heuristic", measure_phase([&] { benchmark_sink += schedule_inspections(inst, C).size(); }, warmup, repetitions));
+        report("dp", measure_phase([&] { benchmark_sink += optimal_dp(inst, C).size(); }, warmup, repetitions));
+        if (binomial(N, C) <= max_combinations)
+            report("brute_force", measure_phase([&] { benchmark_sink += optimal_brute_force(inst, C).size(); },
+                                                min(warmup, 2), repetitions));
+    }
+}
+
+// One CSV row keyed by column name.
+typedef map<string, double> CsvRow;
+
+// Reads a numeric CSV with a header line, e.g. brute_force_runtime.csv.
+vector<CsvRow> read_csv_rows(const string& path) {
+    vector<CsvRow> rows;
+    ifstream in(path);
+    string line;
+    if (!getline(in, line)) return rows;
+    vector<string> header;
+    stringstream hs(line);
+    for (string col; getline(hs, col, ',');) header.push_back(col);
+    while (getline(in, line)) {
+        if (line.empty()) continue;
+        CsvRow row;
+        stringstream ls(line);
+        string cell;
+        for (size_t c = 0; c < header.size() && getline(ls, cell, ','); ++c)
+            row[header[c]] = atof(cell.c_str());
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+// Least-squares slope of log(y) against log(x): the empirical growth exponent.
+double fit_growth_exponent(const vector<double>& x, const vector<double>& y) {
+    double n = 0, sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (x[i] <= 1 || y[i] <= 0) continue;
+        double lx = log(x[i]), ly = log(y[i]);
+        n += 1; sx += lx; sy += ly; sxx += lx * lx; sxy += lx * ly;
+    }
+    double denom = n * sxx - sx * sx;
+    return (n < 2 || denom == 0) ? 0 : (n * sxy - sx * sy) / denom;
+}
+
+// Reads a sweep baseline, i.e. a sweep_*_runtime.csv of an earlier --sweep.
+// The plain brute_force_runtime.csv / approx_runtime.csv lack the L and T
+// columns and time other instances, so they are rejected rather than matched
+// by instance number. Returns false, after saying why, when the file is
+// missing, empty or lacks one of key_columns.
+bool read_sweep_baseline(const string& path, const vector<string>& key_columns, vector<CsvRow>& rows) {
+    rows = read_csv_rows(path);
+    if (rows.empty()) {
+        cout << "no baseline rows in " << path << "\n";
+        return false;
+    }
+    for (const auto& col : key_columns) {
+        if (!rows[0].count(col)) {
+            cout << path << " has no " << col << " column; only sweep_*_runtime.csv baselines can be compared\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Compares current runtimes against baseline rows in the same format. Rows
+// are grouped by key_columns, which have to identify a configuration, and
+// each group's median runtime is compared.
+// Returns true when the geometric mean of current/baseline exceeds
+// 1 + threshold, or when no configuration could be compared at all.
+bool runtime_regressed(const string& solver, const string& baseline_path, const vector<CsvRow>& baseline,
+                       const vector<CsvRow>& current, const vector<string>& key_columns, double threshold) {
+    auto medians = [&](const vector<CsvRow>& rows) {
+        map<vector<double>, vector<double>> groups;
+        for (const auto& row : rows) {
+            vector<double> key;
+            for (const auto& col : key_columns) key.push_back(row.count(col) ? row.at(col) : 0);
+            if (row.count("Runtime(us)")) groups[key].push_back(row.at("Runtime(us)"));
+        }
+        map<vector<double>, double> result;
+        for (auto& g : groups) {
+            sort(g.second.begin(), g.second.end());
+            result[g.first] = g.second[g.second.size() / 2];
+        }
+        return result;
+    };
+
+    auto base = medians(baseline), now = medians(current);
+    double log_ratio = 0;
+    int matched = 0;
+    for (const auto& b : base) {
+        auto it = now.find(b.first);
+        if (it == now.end() || b.second <= 0 || it->second <= 0) continue;
+        log_ratio += log(it->second / b.second);
+        ++matched;
+    }
+    if (matched == 0) {
+        cout << solver << ": no configurations in common with " << baseline_path << "\n";
+        return true;
+    }
+    double ratio = exp(log_ratio / matched);
+    bool regressed = ratio > 1 + threshold;
+    cout << solver << ": " << ratio << "x baseline over " << matched << " configurations"
+         << (regressed ? " -- REGRESSION\n" : "\n");
+    return regressed;
+}
+
+// Seed of the sweep's instances. It is fixed rather than taken from --seed,
+// so every sweep, and every baseline it is compared with, times the same
+// instances.
+const uint64_t SWEEP_SEED = 1;
+
+// Sweeps L, C, student counts and the D-day horizon, writing the runtimes in
+// the brute_force_runtime.csv / approx_runtime.csv formats plus L and T
+// columns (median of the benchmark harness, in µs) and fitting growth
+// exponents per solver. With baselines given, returns non-zero when a solver
+// regressed by more than threshold (a fraction, e.g. 0.25); rows are matched
+// by configuration (instance number, with its L, C and T), never pooled. A
+// baseline that cannot be read or matches nothing fails the run too. The
+// baselines are read before anything is written, so the previous sweep's
+// output can serve as the baseline of the next.
+int run_sweep(const string& brute_force_baseline, const string& approx_baseline, double threshold) {
+    const vector<string> bf_key = { "Instance", "L", "N", "C", "T" };
+    const vector<string> approx_key = { "Instance", "L", "C", "T" };
+    vector<CsvRow> bf_baseline_rows, approx_baseline_rows;
+    if (!brute_force_baseline.empty() && !read_sweep_baseline(brute_force_baseline, bf_key, bf_baseline_rows)) return 1;
+    if (!approx_baseline.empty() && !read_sweep_baseline(approx_baseline, approx_key, approx_baseline_rows)) return 1;
+
+    // The grid is timed in several interleaved rounds of samples of at least
+    // 100 µs, and each configuration reports the median of its round medians,
+    // so a burst of machine load skews one round rather than a run of
+    // configurations.
+    const int rounds = 5;
+    const int repetitions = 11;
+    const long long min_sample_ns = 100000;
+    const long long max_combinations = 2000000;
+    const uint64_t seed = SWEEP_SEED;
+
+    struct SweepPoint {
+        int L, C, T, N;
+        long long combinations;
+        Instance inst;
+        vector<double> heuristic_us, dp_us, bf_us;     // One median per round
+    };
+    vector<SweepPoint> points;
+    int instance_id = 0;
+    for (int L : { 3, 6, 12 })
+    for (int C : { 2, 3, 4 })
+    for (int max_students : { 5, 10, 20 })
+    for (int D : { 1, 2, 4 }) {
+        int T = D * 24;
+        ++instance_id;
+        SweepPoint p;
+        p.L = L;
+        p.C = C;
+        p.T = T;
+        p.inst = build_instance(generate_random_instance(L, max_students, 24, seed, instance_id), T);
+        p.N = collect_events(p.inst).size();
+        p.combinations = binomial(p.N, C);
+        points.push_back(move(p));
+    }
+
+    for (int round = 0; round < rounds; ++round) {
+        for (SweepPoint& p : points) {
+            p.heuristic_us.push_back(measure_phase([&] { benchmark_sink += schedule_inspections(p.inst, p.C).size(); },
+                                                   3, repetitions, min_sample_ns).median_ns / 1000);
+            p.dp_us.push_back(measure_phase([&] { benchmark_sink += optimal_dp(p.inst, p.C).size(); },
+                                            3, repetitions, min_sample_ns).median_ns / 1000);
+            if (p.combinations <= max_combinations)
+                p.bf_us.push_back(measure_phase([&] { benchmark_sink += optimal_brute_force(p.inst, p.C).size(); },
+                                                1, repetitions, min_sample_ns).median_ns / 1000);
+        }
+    }
+    auto median = [](vector<double> v) {
+        sort(v.begin(), v.end());
+        return v[v.size() / 2];
+    };
+
+    ofstream bf_csv("sweep_brute_force_runtime.csv");
+    bf_csv << "Instance,N,C,Combinations,Runtime(us),L,T\n";
+    ofstream approx_csv("sweep_approx_runtime.csv");
+    approx_csv << "Instance,C,Runtime(us),L,T\n";
+
+    vector<CsvRow> bf_rows, approx_rows;
+    vector<double> n_values, combination_values, heuristic_us, dp_us, bf_n, bf_us;
+    for (size_t k = 0; k < points.size(); ++k) {
+        const SweepPoint& p = points[k];
+        int id = k + 1;
+        double h = median(p.heuristic_us), d = median(p.dp_us);
+        approx_csv << id << "," << p.C << "," << h << "," << p.L << "," << p.T << "\n";
+        approx_rows.push_back({ { "Instance", id }, { "C", p.C }, { "Runtime(us)", h }, { "L", p.L }, { "T", p.T } });
+        n_values.push_back(p.N);
+        heuristic_us.push_back(h);
+        dp_us.push_back(d);
+
+        if (!p.bf_us.empty()) {
+            double b = median(p.bf_us);
+            bf_csv << id << "," << p.N << "," << p.C << "," << p.combinations << "," << b << "," << p.L << ","
+                   << p.T << "\n";
+            bf_rows.push_back({ { "Instance", id }, { "N", p.N }, { "C", p.C },
+                                { "Combinations", (double)p.combinations }, { "Runtime(us)", b },
+                                { "L", p.L }, { "T", p.T } });
+            bf_n.push_back(p.N);
+            combination_values.push_back(p.combinations);
+            bf_us.push_back(b);
+        }
+    }
+
+    cout << "Swept " << instance_id << " configurations\n";
+    cout << "Growth exponents (runtime ~ x^k):\n";
+    cout << " heuristic vs N: " << fit_growth_exponent(n_values, heuristic_us) << "\n";
+    cout << " DP vs N: " << fit_growth_exponent(n_values, dp_us) << "\n";
+    cout << " brute force vs N: " << fit_growth_exponent(bf_n, bf_us) << "\n";
+    cout << " brute force vs C(N, C): " << fit_growth_exponent(combination_values, bf_us) << "\n";
+
+    bool regressed = false;
+    if (!brute_force_baseline.empty())
+        regressed |= runtime_regressed("brute force", brute_force_baseline, bf_baseline_rows, bf_rows, bf_key,
+                                       threshold);
+    if (!approx_baseline.empty())
+        regressed |= runtime_regressed("heuristic", approx_baseline, approx_baseline_rows, approx_rows, approx_key,
+                                       threshold);
+    return regressed ? 1 : 0;
+}
+
+//--------------------------binary instance files-------------------------
+// Versioned binary instance set, laid out so it can be memory-mapped and read
+// in place (native byte order, every section 8-byte aligned):
+//   InstanceFileHeader
+//   InstanceFileEntry[instance_count]
+//   per instance at data_offset: uint64 offsets[L + 1], int32 durations[n],
+//   then int32 prefix[n] (per-lab finish times) when INSTANCE_FILE_PREFIX is set
+struct InstanceFileHeader {
+    char magic[8];              // "LABINST"
+    uint32_t version;
+    uint32_t flags;
+    uint64_t instance_count;
+};
+
+struct InstanceFileEntry {
+    uint64_t data_offset;
+    uint64_t num_durations;
+    int32_t L;
+    int32_t T;
+};
+
+const char INSTANCE_FILE_MAGIC[8] = "LABINST";
+const uint32_t INSTANCE_FILE_VERSION = 1;
+const uint32_t INSTANCE_FILE_PREFIX = 1;
+
+// Zero-copy view of one instance inside a mapped file.
+struct InstanceView {
+    int L = 0;
+    int T = 0;
+    const uint64_t* offsets = nullptr;
+    const int* durations = nullptr;
+    const int* prefix = nullptr;    // Null when the file carries no prefix sums
+};
+
+// Read-only mapping of an instance file. The pages are shared, so worker
+// processes opening the same file share one copy in the page cache.
+class MappedInstanceFile {
+public:
+    MappedInstanceFile() = default;
+    MappedInstanceFile(const MappedInstanceFile&) = delete;
+    MappedInstanceFile& operator=(const MappedInstanceFile&) = delete;
+    ~MappedInstanceFile() { close(); }
+
+    // Maps the file and validates its header and directory. On failure
+    // returns false and describes the problem in error.
+    bool open(const string& path, string& error) {
+        close();
+#ifdef SCHEDULER_HAS_MMAP
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { error = "cannot open " + path; return false; }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); error = "cannot stat " + path; return false; }
+        size_ = st.st_size;
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { size_ = 0; error = "cannot map " + path; return false; }
+        data_ = static_cast<const char*>(p);
+#else
+        ifstream in(path, ios::binary);
+        if (!in) { error = "cannot open " + path; return false; }
+        fallback_.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        data_ = fallback_.data();
+        size_ = fallback_.size();
+#endif
+        if (!validate(error)) { close(); return false; }
+        return true;
+    }
+
+    void close() {
+#ifdef SCHEDULER_HAS_MMAP
+        if (data_) munmap(const_cast<char*>(data_), size_);
+#else
+        fallback_.clear();
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    uint64_t count() const { return header()->instance_count; }
+
+    InstanceView view(uint64_t i) const {
+        const InstanceFileEntry& e = entries()[i];
+        InstanceView v;
+        v.L = e.L;
+        v.T = e.T;
+        v.offsets = reinterpret_cast<const uint64_t*>(data_ + e.data_offset);
+        v.durations = reinterpret_cast<const int*>(v.offsets + e.L + 1);
+        if (header()->flags & INSTANCE_FILE_PREFIX) v.prefix = v.durations + e.num_durations;
+        return v;
+    }
+
+private:
+    const InstanceFileHeader* header() const { return reinterpret_cast<const InstanceFileHeader*>(data_); }
+    const InstanceFileEntry* entries() const {
+        return reinterpret_cast<const InstanceFileEntry*>(data_ + sizeof(InstanceFileHeader));
+    }
+
+    bool validate(string& error) const {
+        if (size_ < sizeof(InstanceFileHeader) || memcmp(header()->magic, INSTANCE_FILE_MAGIC, 8) != 0) {
+            error = "not an instance file";
+            return false;
+        }
+        if (header()->version != INSTANCE_FILE_VERSION) {
+            error = "unsupported instance file version " + to_string(header()->version);
+            return false;
+        }
+        uint64_t n = header()->instance_count;
+        if (n > (size_ - sizeof(InstanceFileHeader)) / sizeof(InstanceFileEntry)) {
+            error = "truncated directory";
+            return false;
+        }
+        uint64_t arrays = (header()->flags & INSTANCE_FILE_PREFIX) ? 2 : 1;
+        for (uint64_t i = 0; i < n; ++i) {
+            const InstanceFileEntry& e = entries()[i];
+            if (e.T < 0) {
+                error = "instance " + to_string(i) + " has a negative horizon";
+                return false;
+            }
+            if (e.L < 0 || e.num_durations > size_ || e.data_offset % 8 != 0 || e.data_offset > size_ ||
+                (e.L + 1ULL) * sizeof(uint64_t) + arrays * e.num_durations * sizeof(int32_t) > size_ - e.data_offset) {
+                error = "instance " + to_string(i) + " lies outside the file";
+                return false;
+            }
+            // Every lab's range has to lie within the instance's durations
+            const uint64_t* offsets = reinterpret_cast<const uint64_t*>(data_ + e.data_offset);
+            bool consistent = offsets[0] == 0 && offsets[e.L] == e.num_durations;
+            for (int32_t l = 0; l < e.L && consistent; ++l)
+                consistent = offsets[l] <= offsets[l + 1];
+            if (!consistent) {
+                error = "instance " + to_string(i) + " has inconsistent offsets";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifndef SCHEDULER_HAS_MMAP
+    vector<char> fallback_;
+#endif
+};
+
+// Writes instances (each with its horizon) as a binary instance file.
+bool write_instance_file(const string& path, const vector<pair<DurationsCsr, int>>& instances, bool with_prefix) {
+    ofstream out(path, ios::binary);
+    if (!out) return false;
+    auto pad = [&](uint64_t bytes) {
+        static const char zeros[8] = {};
+        out.write(zeros, (8 - bytes % 8) % 8);
+    };
+
+    InstanceFileHeader header;
+    memcpy(header.magic, INSTANCE_FILE_MAGIC, 8);
+    header.version = INSTANCE_FILE_VERSION;
+    header.flags = with_prefix ? INSTANCE_FILE_PREFIX : 0;
+    header.instance_count = instances.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    uint64_t position = sizeof(InstanceFileHeader) + instances.size() * sizeof(InstanceFileEntry);
+    for (const auto& inst : instances) {
+        InstanceFileEntry e;
+        e.data_offset = position;
+        e.num_durations = inst.first.durations.size();
+        e.L = inst.first.offsets.size() - 1;
+        e.T = inst.second;
+        out.write(reinterpret_cast<const char*>(&e), sizeof(e));
+        uint64_t bytes = (e.L + 1) * sizeof(uint64_t) + (with_prefix ? 2 : 1) * e.num_durations * sizeof(int32_t);
+        position += bytes + (8 - bytes % 8) % 8;
+    }
+
+    for (const auto& inst : instances) {
+        const DurationsCsr& csr = inst.first;
+        out.write(reinterpret_cast<const char*>(csr.offsets.data()), csr.offsets.size() * sizeof(uint64_t));
+        out.write(reinterpret_cast<const char*>(csr.durations.data()), csr.durations.size() * sizeof(int32_t));
+        uint64_t bytes = csr.durations.size() * sizeof(int32_t);
+        if (with_prefix) {
+            vector<int> prefix(csr.durations.size());
+            for (size_t l = 0; l + 1 < csr.offsets.size(); ++l) {
+                long long running = 0; // convert_instance_csv keeps every lab total within an int
+                for (uint64_t j = csr.offsets[l]; j < csr.offsets[l + 1]; ++j)
+                    prefix[j] = running += csr.durations[j];
+            }
+            out.write(reinterpret_cast<const char*>(prefix.data()), prefix.size() * sizeof(int32_t));
+            bytes *= 2;
+        }
+        pad(bytes);
+    }
+    return (bool)out;
+}
+
+// Converts the text form, one lab per line:
+//   Instance,T,Lab,Durations
+//   1,24,1,3 5 8
+// Labs of an instance are consecutive lines; durations keep their queue order.
+bool convert_instance_csv(const string& csv_path, const string& bin_path, bool with_prefix, string& error) {
+    ifstream in(csv_path);
+    if (!in) { error = "cannot open " + csv_path; return false; }
+
+    vector<pair<DurationsCsr, int>> instances;
+    string line;
+    long long current_id = numeric_limits<long long>::min();
+    int line_number = 0;
+    while (getline(in, line)) {
+        ++line_number;
+        if (line.empty() || !isdigit((unsigned char)line[0])) continue; // header or comment
+        stringstream ls(line);
+        string id_field, t_field, lab_field, durations_field;
+        if (!getline(ls, id_field, ',') || !getline(ls, t_field, ',') || !getline(ls, lab_field, ',')) {
+            error = "line " + to_string(line_number) + ": expected Instance,T,Lab,Durations";
+            return false;
+        }
+        getline(ls, durations_field);
+        long long id = atoll(id_field.c_str());
+        long long T = atoll(t_field.c_str());
+        if (T < 0 || T > numeric_limits<int>::max()) {
+            error = "line " + to_string(line_number) + ": horizon out of range";
+            return false;
+        }
+        if (instances.empty() || id != current_id) {
+            instances.push_back({ DurationsCsr(), (int)T });
+            instances.back().first.offsets.push_back(0);
+            current_id = id;
+        }
+        // Durations are positive and a lab's total has to fit an int finish time
+        DurationsCsr& csr = instances.back().first;
+        stringstream ds(durations_field);
+        long long total = 0;
+        for (long long d; ds >> d;) {
+            total += d;
+            if (d < 1 || total > numeric_limits<int>::max()) {
+                error = "line " + to_string(line_number) + ": durations have to be positive and sum to at most " +
+                        to_string(numeric_limits<int>::max());
+                return false;
+            }
+            csr.durations.push_back(d);
+        }
+        csr.offsets.push_back(csr.durations.size());
+    }
+    if (!write_instance_file(bin_path, instances, with_prefix)) {
+        error = "cannot write " + bin_path;
+        return false;
+    }
+    cout << "Wrote " << instances.size() << " instances to " << bin_path << "\n";
+    return true;
+}
+
+// Solves every instance of a mapped file, reading durations in place.
+int solve_instance_file(const string& path, int C, ResultSink& sink, SolutionCache* cache) {
+    MappedInstanceFile file;
+    string error;
+    if (!file.open(path, error)) {
+        cerr << error << "\n";
+        return 1;
+    }
+    for (uint64_t i = 0; i < file.count(); ++i) {
+        InstanceView v = file.view(i);
+        Instance inst;
+        if (!build_instance_into(inst, v.L, v.offsets, v.durations, v.T, v.prefix, C)) {
+            cerr << "instance " << i << " has invalid durations\n";
+            sink.close();
+            return 1;
+        }
+        sink.submit(solve_instance(i + 1, inst, C, cache), C);
+    }
+    sink.close();
+    return 0;
+}
+
+//--------------------------solver service-------------------------
+// Resident mode: newline-framed requests on stdin or a Unix domain socket,
+// one response line per request, tagged with the request id (responses of
+// one connection may come back out of order).
+//   request:  id solver C T L  n_1 d ... d  ...  n_L d ... d
+//             solver is heuristic, dp or exact; lab l lists n_l durations
+//   response: id ok idle t_1 ... t_C | id infeasible | id error message
+// Readers only frame lines; a pool of workers takes them in batches, parses
+// and solves them in per-worker buffers that are reused across requests.
+// T and every duration stay below MAX_SERVE_TIME, so finish times cannot
+// overflow an int, and C is capped at MAX_SERVE_INSPECTIONS; a request for
+// more inspections than there are finish times within T is infeasible. A
+// request that still fails (e.g. out of memory) gets an error response and
+// the service carries on.
+const long long MAX_SERVE_TIME = 1 << 30;
+const long long MAX_SERVE_INSPECTIONS = 1 << 12;
+
+struct ServeConnection {
+    int fd = -1;                // -1 writes to stdout
+    mutex write_mutex;
+
+    ~ServeConnection() {
+#ifdef SCHEDULER_HAS_MMAP
+        if (fd >= 0) ::close(fd);
+#endif
+    }
+
+    void send(const string& text) {
+        lock_guard<mutex> lock(write_mutex);
+        if (fd < 0) {
+            fwrite(text.data(), 1, text.size(), stdout);
+            fflush(stdout);
+            return;
+        }
+#ifdef SCHEDULER_HAS_MMAP
+        for (size_t sent = 0; sent < text.size();) {
+            ssize_t n = ::write(fd, text.data() + sent, text.size() - sent);
+            if (n <= 0) return; // peer went away
+            sent += n;
+        }
+#endif
+    }
+};
+
+struct ServeRequest {
+    shared_ptr<ServeConnection> connection;
+    string line;
+    steady_clock::time_point received;
+};
+
+// State owned by one worker thread.
+struct ServeWorker {
+    DurationsCsr csr;
+    Instance inst;
+    vector<int> times;
+    string response;
+    vector<ServeRequest> batch;
+    vector<double> latency_us;
+};
+
+class SolverService {
+public:
+    static const int BATCH = 32;
+
+    explicit SolverService(int num_threads) : workers_(max(1, num_threads)) {
+        for (size_t w = 0; w < workers_.size(); ++w)
+            threads_.emplace_back([this, w] { work(workers_[w]); });
+    }
+
+    ~SolverService() { stop(); }
+
+    void submit(const shared_ptr<ServeConnection>& connection, string line) {
+        {
+            lock_guard<mutex> lock(mutex_);
+            queue_.push_back({ connection, move(line), steady_clock::now() });
+        }
+        ready_cv_.notify_one();
+    }
+
+    // Answers everything queued, then joins the workers.
+    void stop() {
+        {
+            lock_guard<mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_cv_.notify_all();
+        for (auto& th : threads_)
+            if (th.joinable()) th.join();
+    }
+
+    // Request latencies (receipt to response written), once stopped.
+    vector<double> latencies() const {
+        vector<double> all;
+        for (const auto& w : workers_) all.insert(all.end(), w.latency_us.begin(), w.latency_us.end());
+        return all;
+    }
+
+private:
+    void work(ServeWorker& w) {
+        while (true) {
+            {
+                unique_lock<mutex> lock(mutex_);
+                ready_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                w.batch.clear();
+                while (!queue_.empty() && (int)w.batch.size() < BATCH) {
+                    w.batch.push_back(move(queue_.front()));
+                    queue_.pop_front();
+                }
+            }
+            // Responses to consecutive requests of one connection go out in one write
+            w.response.clear();
+            for (size_t k = 0; k < w.batch.size(); ++k) {
+                answer(w, w.batch[k].line);
+                if (k + 1 == w.batch.size() || w.batch[k + 1].connection != w.batch[k].connection) {
+                    w.batch[k].connection->send(w.response);
+                    w.response.clear();
+                }
+            }
+            auto now = steady_clock::now();
+            for (const auto& r : w.batch)
+                w.latency_us.push_back(duration<double, micro>(now - r.received).count());
+        }
+    }
+
+    // Appends the response to one request line; a request that throws is
+    // answered with an error instead of taking the worker down.
+    static void answer(ServeWorker& w, const string& line) {
+        size_t mark = w.response.size();
+        try {
+            solve_request(w, line);
+        } catch (const exception& e) {
+            w.response.resize(mark);
+            char* end = nullptr;
+            long long id = strtoll(line.c_str(), &end, 10);
+            w.response += end == line.c_str() ? string("-") : to_string(id);
+            w.response += " error ";
+            w.response += e.what();
+            w.response += '\n';
+        }
+    }
+
+    // calculate_total_unoccupied_time in 64 bits: with horizons up to
+    // MAX_SERVE_TIME the idle of a large request does not fit an int.
+    static long long idle_of(const Instance& inst, const vector<int>& times) {
+        long long total = 0;
+        int C = min((int)times.size(), inst.rows);
+        for (int i = 0; i < C; ++i) {
+            const int* row = inst.by_index.data() + (size_t)i * inst.stride;
+            for (int l = 0; l < inst.L; ++l) total += max(0, times[i] - row[l]);
+        }
+        return total;
+    }
+
+    // Parses one request line into the worker's buffers and appends the response.
+    static void solve_request(ServeWorker& w, const string& line) {
+        const char* p = line.c_str();
+        char* end = nullptr;
+        auto next_int = [&](long long& value) {
+            value = strtoll(p, &end, 10);
+            if (end == p) return false;
+            p = end;
+            return true;
+        };
+        auto fail = [&](const char* message) {
+            w.response += message;
+            w.response += "\n";
+        };
+
+        long long id;
+        if (!next_int(id)) return fail("- error missing request id");
+        w.response += to_string(id);
+        while (*p == ' ' || *p == '\t') ++p;
+        const char* solver = p;
+        while (*p && *p != ' ' && *p != '\t') ++p;
+        string name(solver, p);
+        if (name != "heuristic" && name != "dp" && name != "exact")
+            return fail(" error unknown solver (heuristic, dp or exact)");
+
+        long long C, T, L;
+        if (!next_int(C) || !next_int(T) || !next_int(L) || C < 1 || T < 0 || L < 1 || L > (1 << 24))
+            return fail(" error expected C T L with C >= 1, T >= 0, L >= 1");
+        if (T >= MAX_SERVE_TIME) return fail(" error T too large");
+        if (C > MAX_SERVE_INSPECTIONS) return fail(" error C too large");
+        w.csr.offsets.assign(1, 0);
+        w.csr.durations.clear();
+        for (long long l = 0; l < L; ++l) {
+            long long n, d;
+            if (!next_int(n) || n < 0) return fail(" error bad student count");
+            for (long long k = 0; k < n; ++k) {
+                if (!next_int(d) || d < 1 || d >= MAX_SERVE_TIME) return fail(" error bad duration");
+                w.csr.durations.push_back(d);
+            }
+            w.csr.offsets.push_back(w.csr.durations.size());
+        }
+        if (!build_instance_into(w.inst, L, w.csr.offsets.data(), w.csr.durations.data(), T, nullptr, C))
+            return fail(" error bad duration");
+        if ((size_t)C > collect_events(w.inst).size()) return fail(" infeasible");
+
+        if (name == "heuristic") w.times = schedule_inspections(w.inst, C);
+        else if (name == "dp") w.times = optimal_dp_lean(w.inst, C, DpReconstruction::Automatic, nullptr);
+        else w.times = optimal_branch_and_bound(w.inst, C);
+
+        if (w.times.empty()) return fail(" infeasible");
+        w.response += " ok ";
+        w.response += to_string(idle_of(w.inst, w.times));
+        for (int t : w.times) {
+            w.response += ' ';
+            w.response += to_string(t);
+        }
+        w.response += '\n';
+    }
+
+    vector<ServeWorker> workers_;
+    vector<thread> threads_;
+    mutex mutex_;
+    condition_variable ready_cv_;
+    deque<ServeRequest> queue_;
+    bool stopping_ = false;
+};
+
+// Serves stdin until EOF, then reports request latency percentiles on stderr.
+int serve_stdin(int num_threads) {
+    SolverService service(num_threads);
+    auto out = make_shared<ServeConnection>();
+    string line;
+    while (getline(cin, line)) {
+        if (!line.empty()) service.submit(out, move(line));
+    }
+    service.stop();
+
+    vector<double> lat = service.latencies();
+    if (!lat.empty()) {
+        sort(lat.begin(), lat.end());
+        auto pct = [&](double q) { return lat[min(lat.size() - 1, (size_t)(q * lat.size()))]; };
+        cerr << "Served " << lat.size() << " requests, latency (us) p50 " << pct(0.5) << ", p99 " << pct(0.99)
+             << ", max " << lat.back() << "\n";
+    }
+    return 0;
+}
+
+// Serves a Unix domain socket at path until killed; one reader thread per client.
+int serve_socket(const string& path, int num_threads) {
+#ifdef SCHEDULER_HAS_MMAP
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (listener < 0 || path.size() >= sizeof(addr.sun_path)) {
+        cerr << "cannot create socket " << path << "\n";
+        return 1;
+    }
+    strcpy(addr.sun_path, path.c_str());
+    unlink(path.c_str());
+    if (bind(listener, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+        cerr << "cannot listen on " << path << ": " << strerror(errno) << "\n";
+        ::close(listener);
+        return 1;
+    }
+    cerr << "Listening on " << path << "\n";
+
+    // Readers are detached and may outlive this frame, so they share ownership
+    auto service = make_shared<SolverService>(num_threads);
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        auto connection = make_shared<ServeConnection>();
+        connection->fd = fd;
+        thread([service, connection] {
+            // Frame lines out of the byte stream
+            string pending;
+            char buffer[65536];
+            ssize_t n;
+            while ((n = ::read(connection->fd, buffer, sizeof(buffer))) > 0) {
+                pending.append(buffer, n);
+                size_t start = 0;
+                for (size_t nl; (nl = pending.find('\n', start)) != string::npos; start = nl + 1) {
+                    if (nl > start) service->submit(connection, pending.substr(start, nl - start));
+                }
+                pending.erase(0, start);
+            }
+            shutdown(connection->fd, SHUT_RD);
+        }).detach();
+    }
+    ::close(listener);
+    return 1;
+#else
+    (void)num_threads;
+    cerr << "Unix sockets are not available on this platform (" << path << ")\n";
+    return 1;
+#endif
+}
+
+// Removes "name value" from the command line and returns value, or fallback
+// when the option is absent.
+string take_option(int& argc, char* argv[], const string& name, const string& fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (argv[i] == name) {
+            string value = argv[i + 1];
+            for (int j = i; j + 2 < argc; ++j) argv[j] = argv[j + 2];
+            argc -= 2;
+            return value;
+        }
+    }
+    return fallback;
+}
+
+// Removes a bare flag from the command line; true if it was present.
+bool take_flag(int& argc, char* argv[], const string& name) {
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i] == name) {
+            for (int j = i; j + 1 < argc; ++j) argv[j] = argv[j + 1];
+            --argc;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    const int L = 3;        // Number of labs
+    const int C = 2;        // Number of inspections
+    const int D = 1;        // Days (for time horizon)
+    const int T = D * 24;   // Total available time
+
+    // --seed S makes a run reproducible; instance k of seed S can be regenerated
+    // on its own with --replay k
+    uint64_t seed = strtoull(take_option(argc, argv, "--seed", to_string(time(nullptr))).c_str(), nullptr, 10);
+    cerr << "Seed: " << seed << "\n";
+
+    // Result exporters: --columns PATH adds the binary columnar file, --no-text
+    // and --no-csv drop the human-readable and runtime CSV outputs
+    string columns_path = take_option(argc, argv, "--columns", "");
+    bool text_output = !take_flag(argc, argv, "--no-text");
+    bool csv_output = !take_flag(argc, argv, "--no-csv");
+    ResultSink sink;
+    if (!columns_path.empty())
+        sink.add_exporter(unique_ptr<ResultExporter>(new ColumnFileExporter(columns_path)));
+
+    // --metrics PATH writes the solver counters of every instance as JSON lines
+    string metrics_path = take_option(argc, argv, "--metrics", "");
+    if (!metrics_path.empty()) {
+#if SCHEDULER_INSTRUMENT
+        sink.add_exporter(unique_ptr<ResultExporter>(new MetricsJsonExporter(metrics_path)));
+#else
+        cerr << "--metrics needs a build with -DSCHEDULER_INSTRUMENT=1\n";
+        return 1;
+#endif
+    }
+
+    // --cache PATH answers repeated instances from a solution cache that is
+    // loaded from PATH at start and written back at exit
+    string cache_path = take_option(argc, argv, "--cache", "");
+    SolutionCache cache;
+    SolutionCache* cache_ptr = cache_path.empty() ? nullptr : &cache;
+    if (cache_ptr) {
+        string error;
+        if (!cache.load(cache_path, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+    }
+    auto save_cache = [&]() {
+        if (!cache_ptr) return 0;
+        string error;
+        if (!cache.save(cache_path, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        cerr << "Cache: " << cache.hits() << " hits, " << cache.misses() << " misses, "
+             << cache.size() << " entries\n";
+        return 0;
+    };
+
+    auto arg = [&](int i, int fallback) { return argc > i ? atoi(argv[i]) : fallback; };
+
+    // scheduler --bench-enum [L C T max_students max_duration max_threads]
+    if (argc > 1 && string(argv[1]) == "--bench-enum") {
+        benchmark_enumeration(arg(2, 4), arg(3, 4), arg(4, 96), arg(5, 20), arg(6, 8), seed, arg(7, 0));
+        return 0;
+    }
+
+    // scheduler --batch [num_instances threads L C T]
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        if (text_output) sink.add_exporter(unique_ptr<ResultExporter>(new RowExporter(cout)));
+        run_batch(arg(2, 100000), arg(3, 0), arg(4, L), arg(5, C), arg(6, T), seed, sink, cache_ptr);
+        return save_cache();
+    }
+
+    // scheduler --local-search [L C T max_students max_duration restarts iterations threads]
+    if (argc > 1 && string(argv[1]) == "--local-search") {
+        run_local_search(arg(2, 1000), arg(3, 20), arg(4, 240), arg(5, 40), arg(6, 12),
+                         arg(7, 16), arg(8, 200000), arg(9, 0), seed);
+        return 0;
+    }
+
+    // scheduler --deadline [budget_ms L C T max_students max_duration]
+    if (argc > 1 && string(argv[1]) == "--deadline") {
+        run_anytime(arg(2, 50), arg(3, 1000), arg(4, 20), arg(5, 240), arg(6, 40), arg(7, 12), seed);
+        return 0;
+    }
+
+    // scheduler --dp-memory [L C T max_students max_duration]
+    if (argc > 1 && string(argv[1]) == "--dp-memory") {
+        benchmark_dp_memory(arg(2, 2000), arg(3, 1000), arg(4, 7 * 24 * 60), arg(5, 2000), arg(6, 60), seed);
+        return 0;
+    }
+
+    // scheduler --dp-large [L C T max_students max_duration]
+    if (argc > 1 && string(argv[1]) == "--dp-large") {
+        benchmark_dp_large(arg(2, 2000), arg(3, 500), arg(4, 2000000), arg(5, 5000), arg(6, 400), seed);
+        return 0;
+    }
+
+    // scheduler --capacity [L max_C T max_students max_duration]
+    if (argc > 1 && string(argv[1]) == "--capacity") {
+        run_capacity(arg(2, 3), arg(3, 10), arg(4, T), arg(5, 10), arg(6, 24), seed);
+        return 0;
+    }
+
+    // scheduler --online [L C T max_students max_duration updates]
+    if (argc > 1 && string(argv[1]) == "--online") {
+        return run_online(arg(2, 20), arg(3, 8), arg(4, 480), arg(5, 30), arg(6, 20), arg(7, 18000), seed);
+    }
+
+    // scheduler --pipeline [num_instances threads L C T]
+    if (argc > 1 && string(argv[1]) == "--pipeline") {
+        if (text_output) sink.add_exporter(unique_ptr<ResultExporter>(new RowExporter(cout)));
+        run_pipeline(arg(2, 100000), arg(3, 0), arg(4, L), arg(5, C), arg(6, T), seed, sink, cache_ptr);
+        return save_cache();
+    }
+
+    // scheduler --bench [repetitions max_combinations]
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        run_benchmark(arg(2, 51), seed, arg(3, 1000000));
+        return 0;
+    }
+
+    // scheduler --sweep [brute_force_baseline.csv approx_baseline.csv threshold_percent]
+    if (argc > 1 && string(argv[1]) == "--sweep") {
+        return run_sweep(argc > 2 ? argv[2] : "", argc > 3 ? argv[3] : "", arg(4, 25) / 100.0);
+    }
+
+    // scheduler --convert instances.csv instances.bin [with_prefix]
+    if (argc > 3 && string(argv[1]) == "--convert") {
+        string error;
+        if (!convert_instance_csv(argv[2], argv[3], arg(4, 1) != 0, error)) {
+            cerr << error << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // scheduler --instances instances.bin [C]
+    if (argc > 2 && string(argv[1]) == "--instances") {
+        if (text_output) sink.add_exporter(unique_ptr<ResultExporter>(new RowExporter(cout)));
+        int status = solve_instance_file(argv[2], arg(3, C), sink, cache_ptr);
+        return status != 0 ? status : save_cache();
+    }
+
+    // scheduler --serve [socket_path|-] [threads]; "-" or no path serves stdin
+    if (argc > 1 && string(argv[1]) == "--serve") {
+        string path = argc > 2 ? argv[2] : "-";
+        int threads = arg(3, 0) > 0 ? arg(3, 0) : max(1u, thread::hardware_concurrency());
+        return path == "-" ? serve_stdin(threads) : serve_socket(path, threads);
+    }
+
+    // scheduler --seed S --replay instance_id
+    if (argc > 2 && string(argv[1]) == "--replay") {
+        int instance_id = arg(2, 1);
+        auto durations = generate_instance(L, seed, instance_id);
+        cout << "Instance " << instance_id << " durations per lab:\n";
+        for (int l = 0; l < L; ++l) {
+            cout << " Lab " << l + 1 << ": ";
+            for (int x : durations[l]) cout << x << " ";
+            cout << "\n";
+        }
+        InstanceResult r = solve_instance(instance_id, build_instance(durations, T), C);
+        cout << "Heuristic times: ";
+        for (int t : r.heuristic_times) cout << t << " ";
+        cout << "(idle " << r.heuristic_idle << ")\nOptimal times: ";
+        for (int t : r.optimal_times) cout << t << " ";
+        cout << "(idle " << r.optimal_idle << ")\n";
+        return 0;
+    }
+
+    if (csv_output)
+        sink.add_exporter(unique_ptr<ResultExporter>(new RuntimeCsvExporter("brute_force_runtime.csv", "approx_runtime.csv")));
+    if (text_output)
+        sink.add_exporter(unique_ptr<ResultExporter>(new ReportExporter(cout)));
+
+    const int num_instances = 20; // Try 20 different instances
+    for (int instance_id = 1; instance_id <= num_instances; ++instance_id) {
+        auto durations = generate_instance(L, seed, instance_id);
+        Instance inst = build_instance(durations, T);
+        sink.submit(solve_instance(instance_id, inst, C, cache_ptr), C);
+    }
+    sink.close();
+    if (save_cache() != 0) return 1;
+
+    cout << "\nFinished running " << num_instances << " instances.\n";
+
+   
+    return 0;
+}